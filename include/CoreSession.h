@@ -0,0 +1,82 @@
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+/* CoreSession
+ *
+ * The state of one scan of a device or one applied operation in GParted_Core.
+ * A session is created on the stack of the thread doing the work and is found
+ * again by everything that thread calls through CoreSession::get(), including
+ * the libparted exception handler.  So scans and operations running in
+ * different threads don't share libparted messages, file system objects, which
+ * keep the output of their last command, or the results of probing commands.
+ *
+ * Sessions nest: a session created while the thread already has one hides it
+ * until it is destroyed.  A thread calling get() without a session is given
+ * one which is deleted when the thread exits.  The current session of a thread
+ * is kept in thread specific data, so finding it needs no lock.
+ */
+
+#ifndef CORE_SESSION_H_
+#define CORE_SESSION_H_
+
+#include "../include/Utils.h"
+
+#include <map>
+#include <pthread.h>
+
+namespace GParted
+{
+
+class FileSystem ;
+
+class CoreSession
+{
+public:
+	CoreSession() ;
+	~CoreSession() ;
+
+	static CoreSession & get() ;
+
+	//Output of a read only command inspecting a file system
+	struct ProbeResult
+	{
+		int exit_status ;
+		Glib::ustring output ;
+		Glib::ustring error ;
+	} ;
+
+	std::vector<Glib::ustring> libparted_messages ;
+	std::map< FILESYSTEM, FileSystem * > filesystems ;	//created on first use, see GParted_Core::get_filesystem_object()
+	std::map< Glib::ustring, ProbeResult > probe_results ;	//by locale and command
+	bool table_session ;	//partition table changes are held back, see GParted_Core::get_table_session()
+
+private:
+	CoreSession( const CoreSession & ) ;
+	CoreSession & operator=( const CoreSession & ) ;
+
+	static void create_key() ;
+	static void on_thread_exit( void * session ) ;
+
+	CoreSession * previous ;	//session of the same thread this one hides
+	bool thread_default ;		//created by get(), deleted when the thread exits
+
+	static pthread_once_t key_once ;
+	static pthread_key_t key ;	//current session of each thread
+};
+
+}//GParted
+
+#endif /* CORE_SESSION_H_ */
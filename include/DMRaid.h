@@ -21,7 +21,9 @@
  * This class provides support for motherboard based RAID devices, also know
  * as Fake RAID.
  * Static elements are used in order to reduce the disk accesses required to
- * load the data structures upon each initialization of the class.
+ * load the data structures upon each initialization of the class.  Each object
+ * works on a copy of the cached device list, taken when it is constructed, so
+ * a refresh in another thread doesn't change it underneath.
  */
 
 #ifndef DMRAID_H_
@@ -31,6 +33,7 @@
 #include "../include/Partition.h"
 #include "../include/OperationDetail.h"
 
+#include <glibmm/thread.h>
 #include <vector>
 
 //Declare some constants
@@ -64,16 +67,18 @@ public:
 	bool update_dev_map_entry( const Partition & partition, OperationDetail & operationdetail ) ;
 private:
 	void load_dmraid_cache() ;
-	void set_commands_found() ;
+	bool set_commands_found() ;
 	void get_dmraid_dir_entries( const Glib::ustring & dev_path, std::vector<Glib::ustring> & dir_list ) ;
 	void get_affected_dev_map_entries( const Partition & partition, std::vector<Glib::ustring> & affected_entries ) ;
 	void get_partition_dev_map_entries( const Partition & partition, std::vector<Glib::ustring> & partition_entries ) ;
+	static Glib::Mutex mutex ;
 	static bool dmraid_cache_initialized ;
 	static bool dmraid_found ;
 	static bool dmsetup_found ;
 	static bool udevinfo_found ;
 	static bool udevadm_found ;
-	static std::vector<Glib::ustring> dmraid_devices ;
+	static std::vector<Glib::ustring> dmraid_devices_cache ;
+	std::vector<Glib::ustring> dmraid_devices ;
 };
 
 }//GParted
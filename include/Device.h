@@ -33,8 +33,9 @@ public:
 
 	void add_path( const Glib::ustring & path, bool clear_paths = false ) ;
 	void add_paths( const std::vector<Glib::ustring> & paths, bool clear_paths = false ) ;
-	Glib::ustring get_path() const ;
-	std::vector<Glib::ustring> get_paths() const ;
+	void add_member_paths( const std::vector<Glib::ustring> & paths ) ;
+	const Glib::ustring & get_path() const ;
+	const std::vector<Glib::ustring> & get_paths() const ;
 	/* Returns true if path is a member of get_paths() */
 	bool has_path( const Glib::ustring& path ) const ;
 
@@ -54,6 +55,8 @@ public:
 	int max_prims ;
 	int highest_busy ;
 	bool readonly ; 
+	bool details_known ;		//labels, UUIDs and usage of the partitions have been read
+	unsigned int generation ;	//changes each time the device is (re)scanned
 			
 private:
 	void sort_paths_and_remove_duplicates() ;
@@ -61,6 +64,8 @@ private:
 	static bool compare_paths( const Glib::ustring & A, const Glib::ustring & B ) ;
 	
 	std::vector<Glib::ustring> paths ;
+
+	static unsigned int next_generation ;
 		
 };
  
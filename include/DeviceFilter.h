@@ -0,0 +1,78 @@
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+/* DeviceFilter
+ *
+ * Rules deciding which of the devices found are scanned, read from the file
+ * /etc/gparted/device-filter.conf and from the command line.  A rule is one of:
+ *
+ *   include GLOB          include-regex REGEX
+ *   exclude GLOB          exclude-regex REGEX
+ *   require ATTRIBUTE OPERATOR VALUE
+ *
+ * A glob starting with '/' is matched against the device path, any other glob
+ * against the kernel name, e.g. "loop*".  A regex is searched for in the device
+ * path.  When include rules are given a device has to match one of them, and a
+ * device matching an exclude rule is skipped.  A require rule compares an
+ * attribute from /sys/class/block/NAME/, e.g. "require removable = 0" or
+ * "require size >= 2097152", using one of = != < <= > >=.
+ */
+
+#ifndef DEVICE_FILTER_H_
+#define DEVICE_FILTER_H_
+
+#include "../include/Utils.h"
+
+#include <glibmm/regex.h>
+
+namespace GParted
+{
+
+class DeviceFilter
+{
+public:
+	static bool add_rule( const Glib::ustring & rule ) ;
+	static void load_rules( const Glib::ustring & filename ) ;
+	static bool accept( const Glib::ustring & device_path ) ;
+
+private:
+	enum RuleType
+	{
+		RULE_INCLUDE,
+		RULE_EXCLUDE,
+		RULE_REQUIRE
+	} ;
+
+	struct Rule
+	{
+		RuleType type ;
+		bool match_name ;			//match the kernel name instead of the path
+		Glib::RefPtr<Glib::Regex> regex ;
+		Glib::ustring attribute, comparison, value ;
+	} ;
+
+	static bool matches( const Rule & rule, const Glib::ustring & path, const Glib::ustring & name ) ;
+	static bool attribute_matches( const Rule & rule, const Glib::ustring & name ) ;
+	static Glib::ustring get_kernel_name( const Glib::ustring & device_path ) ;
+	static Glib::ustring glob_to_regex( const Glib::ustring & glob ) ;
+
+	static std::vector<Rule> rules ;
+	static bool have_include_rules ;
+};
+
+}//GParted
+
+#endif /* DEVICE_FILTER_H_ */
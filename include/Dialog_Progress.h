@@ -29,8 +29,13 @@
 #include <gtkmm/treestore.h>
 #include <gtkmm/scrolledwindow.h>
 #include <gtkmm/expander.h>
+#include <gtkmm/spinbutton.h>
+#include <glibmm/main.h>
+#include <glibmm/thread.h>
+#include <glibmm/timer.h>
 
 #include <fstream>
+#include <map>
 
 namespace GParted
 {
@@ -41,14 +46,58 @@ public:
 	Dialog_Progress( const std::vector<Operation *> & operations ) ;
 	~Dialog_Progress();
 	
-	sigc::signal< bool, Operation * > signal_apply_operation ;
+	sigc::signal< bool, const std::vector<Operation *> &, std::vector<OperationResult> &, bool > signal_apply_operations ;
 	sigc::signal< Glib::ustring > signal_get_libparted_version ;
+	sigc::signal< double, const Operation * > signal_estimate_duration ;
+	sigc::signal< bool, const std::vector<Operation *> & > signal_close_partition_tables ;
+
+	static void set_max_parallel_operations( unsigned int max_operations ) ;
 		
 private:
+	enum OperationState
+	{
+		STATE_PENDING,
+		STATE_RUNNING,
+		STATE_DONE
+	} ;
+
+	//What a thread applying an operation is given
+	struct OperationThread
+	{
+		Dialog_Progress * dialog ;
+		std::vector<unsigned int> indexes ;	//the operations applied together
+		bool more_operations ;	//more operations follow on its disks
+	} ;
+
+	//Snapshot of an operation detail, as published by the operation thread
+	struct ProgressUpdate
+	{
+		Glib::ustring treepath ;
+		Glib::ustring description ;
+		Glib::ustring elapsed_time ;
+		OperationDetailStatus status ;
+		double fraction ;
+		Glib::ustring progress_text ;
+	} ;
+
 	void on_signal_update( const OperationDetail & operationdetail ) ;
-	void dispatcher_on_update_gui_elements() ;
+	void update_row( const ProgressUpdate & update ) ;
+	void update_gui_elements() ;
+	void update_progress_all() ;
+	double get_remaining_time() ;
+	void apply_progress_updates() ;
+	void dispatcher_on_progress() ;
+	void dispatcher_on_operation_done() ;
+	bool on_pulse_timeout() ;
 	void on_signal_show() ;
+	unsigned int collect_finished_operations() ;
+	void start_operation( unsigned int index, bool more_operations ) ;
+	void show_operation( unsigned int index ) ;
+	static bool operations_conflict( const Operation * first, const Operation * second ) ;
+	static bool operations_fusable( const Operation * first, const Operation * second ) ;
+	static std::vector<Glib::ustring> get_operation_devices( const Operation * operation ) ;
 	void on_expander_changed() ;
+	void on_limits_changed() ;
 	void on_cell_data_description( Gtk::CellRenderer * renderer, const Gtk::TreeModel::iterator & iter) ;
 	static void *static_pthread_apply_operation( void * p_dialog_progress ) ;
 	void on_cancel() ;
@@ -65,6 +114,7 @@ private:
 	Gtk::TreeRow treerow ;
 	Gtk::ScrolledWindow scrolledwindow ;
 	Gtk::Expander expander_details ;
+	Gtk::SpinButton spinbutton_bandwidth, spinbutton_iops ;
 	
 	Glib::RefPtr<Gdk::Pixbuf> icon_execute ;
 	Glib::RefPtr<Gdk::Pixbuf> icon_succes ;
@@ -90,13 +140,33 @@ private:
 	treeview_operations_Columns treeview_operations_columns;
 	
 	std::vector<Operation *> operations ;
-	OperationDetail operationdetail ;
-	bool running, succes, cancel, pulse ;
-	pthread_t pthread ;
+	std::vector<OperationState> states ;
+	std::vector<OperationThread> operation_threads ;
+	std::vector<pthread_t> pthreads ;
+	std::vector< std::vector<unsigned int> > dependencies ;	//earlier operations each one waits for
+	std::vector<unsigned int> leaders ;	//operation whose thread applies each one
+	std::vector< std::vector<unsigned int> > groups ;	//operations applied by each leader
+	bool succes, cancel, pulse ;
 	double fraction ;
-	unsigned int t, warnings ;
+	unsigned int shown_operation, warnings, completed ;
+	Glib::Timer timer_total ;
+	std::vector<double> estimates ;		//predicted seconds of each operation
+	std::vector<double> start_times ;	//on timer_total
+	static unsigned int max_parallel_operations ;
+
+	Glib::Thread * mainthread ;
+	Glib::RefPtr<Glib::MainLoop> main_loop ;
+	Glib::Mutex progress_mutex ;
+	std::vector<ProgressUpdate> progress_updates ;	//queued by the operation thread
+	std::map<Glib::ustring, unsigned int> progress_update_indexes ;	//treepath -> queued update
+	Glib::Dispatcher dispatcher_progress ;
+	Glib::Dispatcher dispatcher_operation_done ;
+	Glib::Mutex finished_mutex ;
+	std::vector< std::pair<unsigned int, OperationResult> > finished_operations ;	//index and result
+	sigc::connection pulse_connection ;
 
-	Glib::Dispatcher dispatcher_update_gui_elements ;
+	double current_fraction ;
+	Glib::ustring current_progress_text ;
 	Glib::ustring label_current_sub_text ;
 };
 
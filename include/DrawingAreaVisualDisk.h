@@ -21,6 +21,7 @@
 #include "../include/Partition.h"
 
 #include <gtkmm/drawingarea.h>
+#include <gdkmm/pixmap.h>
 
 namespace GParted
 {
@@ -49,13 +50,16 @@ private:
 	void set_static_data( const std::vector<Partition> & partitions, 
 			      std::vector<visual_partition> & visual_partitions,
 			      Sector length ) ;
+	bool update_static_data( const std::vector<Partition> & partitions,
+				 std::vector<visual_partition> & visual_partitions ) ;
 	int calc_length( std::vector<visual_partition> & visual_partitions, int length_px ) ;
 	void calc_position_and_height( std::vector<visual_partition> & visual_partitions, int start, int border ) ;
 	void calc_usage( std::vector<visual_partition> & visual_partitions ) ;
 	void calc_text( std::vector<visual_partition> & visual_partitions ) ;
 	
-	void draw_partition( const visual_partition & vp ) ;
-	void draw_partitions( const std::vector<visual_partition> & visual_partitions ) ;
+	void draw_partition( const Glib::RefPtr<Gdk::Drawable> & drawable, const visual_partition & vp ) ;
+	void draw_partitions( const Glib::RefPtr<Gdk::Drawable> & drawable,
+			      const std::vector<visual_partition> & visual_partitions ) ;
 	
 	void set_selected( const std::vector<visual_partition> & visual_partitions, int x, int y ) ;
 	void set_selected( const std::vector<visual_partition> & visual_partitions, const Partition & partition ) ;
@@ -114,6 +118,9 @@ private:
 	std::vector<visual_partition> visual_partitions ;
 	const visual_partition * selected_vp ;
 	int TOT_SEP, MIN_SIZE ;
+	int layout_width ;			//allocation width the layout was calculated for
+	Sector layout_device_length ;		//device length the layout was calculated for
+	Glib::RefPtr<Gdk::Pixmap> pixmap ;	//partitions drawn for the current layout
 
 	Glib::RefPtr<Gdk::GC> gc;
 	Gdk::Color color_used, color_unused, color_unallocated, color_text;
@@ -20,6 +20,8 @@
 
 #include "../include/Utils.h"
 
+#include <glibmm/thread.h>
+
 namespace GParted
 {
 
@@ -36,8 +38,9 @@ public:
 	Glib::ustring get_path_by_label( const Glib::ustring & label ) ;
 private:
 	void load_fs_info_cache() ;
-	void set_commands_found() ;
+	bool set_commands_found() ;
 	Glib::ustring get_device_entry( const Glib::ustring & path ) ;
+	static Glib::Mutex mutex ;
 	static bool fs_info_cache_initialized ;
 	static bool blkid_found ;
 	static bool vol_id_found ;
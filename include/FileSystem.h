@@ -22,7 +22,9 @@
 
 #include "../include/Operation.h"
 
+#include <glibmm/timer.h>
 #include <fstream>
+#include <map>
 #include <sys/stat.h>
 
 namespace GParted
@@ -43,6 +45,7 @@ public:
 	virtual bool write_label( const Partition & partition, OperationDetail & operationdetail ) = 0 ;
 	virtual void read_uuid( Partition & partition ) = 0 ;
 	virtual bool write_uuid( const Partition & partition, OperationDetail & operationdetail ) = 0 ;
+	virtual bool write_label_and_uuid( const Partition & partition, OperationDetail & operationdetail ) ;
 	virtual bool create( const Partition & new_partition, OperationDetail & operationdetail ) = 0 ;
 	virtual bool resize( const Partition & partition_new,
 			     OperationDetail & operationdetail,
@@ -58,12 +61,20 @@ public:
 	virtual bool remove( const Partition & partition, OperationDetail & operationdetail ) = 0 ;
 
 protected:
-	int execute_command( const Glib::ustring & command, OperationDetail & operationdetail ) ;
+	//Reads the completed fraction from a line of command output
+	typedef bool (*ProgressParser)( const std::string & line, double & fraction ) ;
+
+	int execute_command( const Glib::ustring & command,
+	                     OperationDetail & operationdetail,
+	                     ProgressParser progress_parser = NULL ) ;
+	int execute_probe_command( const Glib::ustring & command, bool use_C_locale = false ) ;
 	int execute_command_timed( const Glib::ustring & command
 	                         , OperationDetail & operationdetail
 	                         , bool check_status = true ) ;
 	Glib::ustring mk_temp_dir( const Glib::ustring & infix, OperationDetail & operationdetail ) ;
 	void rm_temp_dir( const Glib::ustring dir_name, OperationDetail & operationdetail ) ;
+	static bool parse_percent_progress( const std::string & line, double & fraction ) ;
+	static bool parse_resize2fs_progress( const std::string & line, double & fraction ) ;
 
 	//those are used in several places..
 	Glib::ustring output, error ;
@@ -72,7 +83,17 @@ protected:
 	unsigned int index ;
 	
 private:
+	//Progress shown for one run of a command, kept by execute_command() while the
+	//  command runs
+	struct CommandProgress
+	{
+		ProgressParser parser ;
+		OperationDetail * operationdetail ;
+		Glib::Timer timer ;	//time since the current pass started
+		double fraction ;	//last shown, or -1
+	} ;
 
+	static void on_command_output( const std::string & line, CommandProgress * progress ) ;
 };
 
 } //GParted
@@ -26,7 +26,9 @@
 #ifdef HAVE_LIBPARTED_3_1_0_PLUS
 #include <parted/filesys.h>
 #endif
+#include <glibmm/thread.h>
 #include <vector>
+#include <set>
 #include <fstream>
 
 namespace GParted
@@ -36,19 +38,24 @@ class Proc_Partitions_Info;
 class GParted_Core
 {
 public:
-	static Glib::Thread *mainthread;
+	static Glib::Thread *mainthread;	//set once in main(), before any other thread runs
 	GParted_Core() ;
 	~GParted_Core() ;
 
 	void find_supported_filesystems() ;
 	void set_user_devices( const std::vector<Glib::ustring> & user_devices ) ;
-	void set_devices( std::vector<Device> & devices ) ;
+	void set_devices( std::vector<Device> & devices, const Glib::ustring & first_device_path = "" ) ;
+	void get_scanned_devices( std::vector<Device> & devices ) ;
 	void guess_partition_table(const Device & device, Glib::ustring &buff);
 	
 	bool snap_to_cylinder( const Device & device, Partition & partition, Glib::ustring & error ) ;
 	bool snap_to_mebibyte( const Device & device, Partition & partition, Glib::ustring & error ) ;
 	bool snap_to_alignment( const Device & device, Partition & partition, Glib::ustring & error ) ;
-	bool apply_operation_to_disk( Operation * operation );
+	bool apply_operations_to_disk( const std::vector<Operation *> & operations,
+	                               std::vector<OperationResult> & results,
+	                               bool more_operations = false ) ;
+	static double estimate_duration( const Operation * operation ) ;
+	static bool close_held_partition_tables( const std::vector<Operation *> & operations ) ;
 	
 	bool set_disklabel( const Glib::ustring & device_path, const Glib::ustring & disklabel ) ;
 
@@ -65,19 +72,27 @@ public:
 	static FileSystem * get_filesystem_object( const FILESYSTEM & filesystem ) ;
 	static bool filesystem_resize_disallowed( const Partition & partition ) ;
 	static bool parse_device( const Glib::ustring& device_path, Device& temp_device ) ;
-	static bool parse_device( const Glib::ustring& device_path, Proc_Partitions_Info& pp_info, Device& temp_device ) ;
+	static bool parse_device( const Glib::ustring& device_path,
+	                          Proc_Partitions_Info& pp_info,
+	                          Device& temp_device,
+	                          bool read_details = true ) ;
 private:
 	//detectionstuff..
-	void init_maps() ;
+	static Glib::ustring get_programs_key() ;
 	static void set_thread_status_message( Glib::ustring msg ) ;
-	void read_mountpoints_from_file( const Glib::ustring & filename,
-					 std::map< Glib::ustring, std::vector<Glib::ustring> > & map ) ;
-	void read_mountpoints_from_file_swaps(
-		const Glib::ustring & filename,
-		std::map< Glib::ustring, std::vector<Glib::ustring> > & map ) ;
+	static bool partition_table_matches_kernel( PedDisk* lp_disk, const std::vector<Partition> & partitions ) ;
+	static bool kernel_partition_has_holders( const Glib::ustring & partition_dir ) ;
 	static Glib::ustring get_partition_path( PedPartition * lp_partition ) ;
-	static void set_device_partitions( Device & device, PedDevice* lp_device, PedDisk* lp_disk ) ;
-	static GParted::FILESYSTEM get_filesystem( PedDevice* lp_device, PedPartition* lp_partition,
+	static void set_device_partitions( Device & device, PedDevice* lp_device, PedDisk* lp_disk, bool read_details ) ;
+	struct PartitionMagic
+	{
+		std::vector<char> head ;	//start of the partition
+		std::vector<char> super64k ;	//super block area at 64 KiB
+	} ;
+	static void read_partition_magic( PedDevice* lp_device, PedDisk* lp_disk,
+	                                  std::map<int, PartitionMagic> & magics ) ;
+	static GParted::FILESYSTEM get_filesystem( PedPartition* lp_partition,
+	                                           const PartitionMagic & magic,
 	                                           std::vector<Glib::ustring>& messages ) ;
 	static void read_label( Partition & partition ) ;
 	static void read_uuid( Partition & partition ) ;
@@ -97,6 +112,12 @@ private:
 	static void set_flags( Partition & partition, PedPartition* lp_partition ) ;
 	
 	//operationstuff...
+	bool apply_operation_to_disk( Operation * operation ) ;
+	bool apply_fused_operations_to_disk( const std::vector<Operation *> & operations,
+	                                     std::vector<OperationResult> & results ) ;
+	static double estimate_check( const Partition & partition ) ;
+	static double estimate_resize( const Partition & partition_old, const Partition & partition_new ) ;
+	static double estimate_data_move( const Partition & partition_src, const Partition & partition_dst, bool move ) ;
 	bool create( const Device & device, Partition & new_partition, OperationDetail & operationdetail ) ;
 	bool create_partition( Partition & new_partition, OperationDetail & operationdetail, Sector min_size = 0 ) ;
 	bool create_filesystem( const Partition & partition, OperationDetail & operationdetail ) ;
@@ -110,6 +131,7 @@ private:
 	bool label_partition( const Partition & partition, OperationDetail & operation_detail ) ;
 	
 	bool change_uuid( const Partition & partition, OperationDetail & operation_detail ) ;
+	bool label_and_uuid( const Partition & partition, OperationDetail & operationdetail ) ;
 
 	bool resize_move( const Device & device,
 			  const Partition & partition_old,
@@ -185,18 +207,23 @@ private:
 			  bool readonly,
 			  Byte_Value & total_done ) ;
 
-	bool copy_block( PedDevice * lp_device_src,
-			 PedDevice * lp_device_dst,
+	bool copy_block( int fd_src,
+			 int fd_dst,
+			 Byte_Value sector_size_src,
+			 Byte_Value sector_size_dst,
 			 Sector offset_src,
 			 Sector offset_dst,
 			 Byte_Value blocksize,
+			 char * buf,
 			 Glib::ustring & error_message,
 			 bool readonly ) ; 
+	static bool transfer_all( int fd, char * buf, Byte_Value count, Byte_Value offset, bool write ) ;
 	bool calibrate_partition( Partition & partition, OperationDetail & operationdetail ) ;
 	bool calculate_exact_geom( const Partition & partition_old,
 			           Partition & partition_new,
 				   OperationDetail & operationdetail ) ;
 	static FileSystem* set_proper_filesystem( const FILESYSTEM & filesystem ) ;
+	static FileSystem * new_filesystem_object( FILESYSTEM filesystem ) ;
 #ifndef HAVE_LIBPARTED_3_0_0_PLUS
 	bool erase_filesystem_signatures( const Partition & partition ) ;
 #endif
@@ -212,21 +239,47 @@ private:
 	static bool commit_to_os( PedDisk* lp_disk, std::time_t timeout ) ;
 	static void settle_device( std::time_t timeout ) ;
 
+	//partition table sessions, see open_device_and_disk()
+	struct TableSession
+	{
+		PedDevice* lp_device ;
+		PedDisk* lp_disk ;
+		bool dirty ;		//changes not yet written to the device
+		Glib::Thread * owner ;	//thread applying an operation on the disk, or NULL
+	} ;
+	static TableSession * get_table_session( PedDisk* lp_disk ) ;
+	static bool device_in_table_session( PedDevice* lp_device ) ;
+	static bool commit_table_session( const Glib::ustring & device_path,
+	                                  TableSession & session,
+	                                  OperationDetail & operationdetail ) ;
+	static bool flush_partition_tables( OperationDetail & operationdetail ) ;
+	static bool close_partition_tables( OperationDetail & operationdetail ) ;
+	static void release_partition_tables() ;
+	static void note_filesystem_written( const Partition & partition ) ;
+	static void note_filesystem_clean( const Partition & partition ) ;
+	static bool filesystem_known_clean( const Partition & partition ) ;
+
 	static PedExceptionOption ped_exception_handler( PedException * e ) ;
 
 	static std::vector<FS> FILESYSTEMS ;
-	static std::map< FILESYSTEM, FileSystem * > FILESYSTEM_MAP ;
 	static std::vector<PedPartitionFlag> flags;
 	std::vector<Glib::ustring> device_paths ;
 	bool probe_devices ;
+	static Glib::Mutex thread_status_message_mutex ;
 	static Glib::ustring thread_status_message;  //Used to pass data to show_pulsebar method
+	static Glib::RecMutex scan_mutex ;  //Serialises device scans, as libparted isn't thread safe
+	Glib::Mutex scanned_devices_mutex ;
+	std::vector<Device> scanned_devices ;  //Scanned by set_devices(), not yet collected by get_scanned_devices()
+	static Glib::ustring programs_key ;  //$PATH state when FILESYSTEMS was last probed
 	Glib::RefPtr<Glib::IOChannel> iocInput, iocOutput; // Used to send data to gpart command
-	
-	static std::map< Glib::ustring, std::vector<Glib::ustring> > mount_info ;
-	static std::map< Glib::ustring, std::vector<Glib::ustring> > fstab_info ;
-	static std::map< Glib::ustring, std::vector<Glib::ustring> >::iterator iter_mp ;
-	
-	char * buf ;
+
+	static std::map< Glib::ustring, TableSession > table_sessions ;
+
+	//File systems found clean since the last refresh, by geometry, with the write
+	//  generation of the file system when it was checked
+	static std::map< Glib::ustring, unsigned long > clean_checks ;
+	static std::map< Glib::ustring, unsigned long > write_generations ;	//by file system start
+	static unsigned long last_write_generation ;
 };
 
 } //GParted
@@ -35,7 +35,7 @@ public:
 	HBoxOperations() ;
 	~HBoxOperations() ;
 
-	void load_operations( const std::vector<Operation *> operations ) ;
+	void load_operations( const std::vector<Operation *> & operations, const std::vector<double> & durations ) ;
 	void clear() ;
 
 	sigc::signal< void > signal_undo ;
@@ -59,11 +59,15 @@ private:
 	{
 		Gtk::TreeModelColumn<Glib::ustring> operation_description;
 		Gtk::TreeModelColumn< Glib::RefPtr<Gdk::Pixbuf> > operation_icon;
+		Gtk::TreeModelColumn<Glib::ustring> operation_duration;	//estimated
+		Gtk::TreeModelColumn<Operation *> operation;	//not shown
 				
 		treeview_operations_Columns() 
 		{ 
 			add( operation_description );
 			add( operation_icon );
+			add( operation_duration );
+			add( operation );
 		} 
 	};
 	treeview_operations_Columns treeview_operations_columns;
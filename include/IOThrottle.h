@@ -0,0 +1,77 @@
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+/* IOThrottle
+ *
+ * Limits how hard the operations load the disks, so that the system stays usable
+ * while data is moved.  The thread applying an operation gets the chosen I/O
+ * scheduling class, which the commands it runs inherit.  The bandwidth and I/O
+ * operation limits are enforced by a token bucket in the block copy loop, and for
+ * commands through the io.max file of a cgroup, when cgroup v2 with the io
+ * controller is available.  The limits may be changed while an operation runs.
+ */
+
+#ifndef IO_THROTTLE_H_
+#define IO_THROTTLE_H_
+
+#include "../include/Utils.h"
+
+#include <glibmm/thread.h>
+#include <glibmm/timer.h>
+#include <sys/types.h>
+#include <map>
+
+namespace GParted
+{
+
+class IOThrottle
+{
+public:
+	IOThrottle() ;
+	void wait( Byte_Value bytes, unsigned int ios ) ;
+
+	static bool set_priority( const Glib::ustring & priority ) ;
+	static void set_limits( Byte_Value bytes_per_second, unsigned int ios_per_second ) ;
+	static void get_limits( Byte_Value & bytes_per_second, unsigned int & ios_per_second ) ;
+	static void begin_operation( const std::vector<Glib::ustring> & device_paths ) ;
+	static void end_operation() ;
+	static Glib::ustring get_command_prefix() ;
+
+private:
+	struct Group
+	{
+		Glib::ustring path ;
+		std::vector<Glib::ustring> devices ;	//"major:minor" of the disks used
+	} ;
+
+	static pid_t get_thread_id() ;
+	static void set_thread_priority( int priority_class, int priority_level ) ;
+	static bool write_io_max( const Group & group ) ;
+
+	double byte_tokens, io_tokens ;
+	Glib::Timer timer ;
+
+	static Glib::Mutex mutex ;
+	static Byte_Value bytes_per_second ;
+	static unsigned int ios_per_second ;
+	static int priority_class, priority_level ;
+	static std::map<pid_t, Group> groups ;		//cgroup of each operation thread
+	static unsigned int group_count ;
+};
+
+}//GParted
+
+#endif /* IO_THROTTLE_H_ */
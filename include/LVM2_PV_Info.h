@@ -20,7 +20,7 @@
  *
  * A persistent cache of information about LVM2 PVs that helps to
  * minimize the number of executions of lvm commands used to query
- * their attributes.
+ * their attributes.  It may be used by several threads at once.
  */
 
 #ifndef LVM2_PV_INFO_H_
@@ -28,6 +28,8 @@
 
 #include "../include/Utils.h"
 
+#include <glibmm/thread.h>
+
 namespace GParted
 {
 
@@ -47,8 +49,8 @@ public:
 	std::vector<Glib::ustring> get_error_messages( const Glib::ustring & path ) ;
 private:
 	void initialize_if_required() ;
-	void set_command_found() ;
-	void load_lvm2_pv_info_cache() ;
+	bool set_command_found() ;
+	void load_lvm2_pv_info_cache( bool lvm_available ) ;
 	Glib::ustring get_pv_attr_by_path( const Glib::ustring & path, unsigned int entry ) const ;
 	Glib::ustring get_pv_attr_by_row( unsigned int row, unsigned int entry ) const ;
 	Glib::ustring get_vg_attr_by_name( const Glib::ustring & vgname, unsigned int entry ) const ;
@@ -59,6 +61,7 @@ private:
 	                                      unsigned int row, unsigned int entry ) ;
 	static Byte_Value lvm2_pv_attr_to_num( const Glib::ustring str ) ;
 	static bool bit_set( const Glib::ustring & attr, unsigned int bit ) ;
+	static Glib::Mutex mutex ;
 	static bool lvm2_pv_info_cache_initialized ;
 	static bool lvm_found ;
 	static std::vector<Glib::ustring> lvm2_pv_cache ;
@@ -0,0 +1,60 @@
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+/* Mount_Info
+ *
+ * A persistent cache of the mounted file systems and swap spaces from
+ * /proc/mounts, /proc/swaps and /etc/mtab, and of the mount points in /etc/fstab.
+ * It is refreshed when the devices are rescanned and may be read by several
+ * threads at once.
+ */
+
+#ifndef MOUNT_INFO_H_
+#define MOUNT_INFO_H_
+
+#include "../include/Utils.h"
+
+#include <glibmm/thread.h>
+#include <map>
+
+namespace GParted
+{
+
+class Mount_Info
+{
+public:
+	Mount_Info() ;
+	Mount_Info( bool do_refresh ) ;
+	~Mount_Info() ;
+	bool is_mounted( const Glib::ustring & path ) ;
+	std::vector<Glib::ustring> get_mounted_mountpoints( const Glib::ustring & path ) ;
+	std::vector<Glib::ustring> get_fstab_mountpoints( const Glib::ustring & path ) ;
+	std::vector<Glib::ustring> get_all_mountpoints() ;
+private:
+	typedef std::map< Glib::ustring, std::vector<Glib::ustring> > MountMap ;
+
+	void load_mount_info_cache() ;
+	static void read_mountpoints_from_file( const Glib::ustring & filename, MountMap & map ) ;
+	static void read_mountpoints_from_file_swaps( const Glib::ustring & filename, MountMap & map ) ;
+	static Glib::Mutex mutex ;
+	static bool mount_info_cache_initialized ;
+	static MountMap mount_info ;
+	static MountMap fstab_info ;
+};
+
+}//GParted
+
+#endif /* MOUNT_INFO_H_ */
@@ -22,6 +22,8 @@
 #include "../include/Device.h"
 #include "../include/OperationDetail.h"
 
+#include <map>
+
 namespace GParted
 {
 	//FIXME: stop using GParted:: in front of our own enums.. it's not necessary and clutters the code
@@ -36,18 +38,44 @@ enum OperationType {
 	OPERATION_CHANGE_UUID	= 7
 };
 
+//Outcome of applying an operation
+enum OperationResult {
+	RESULT_NOT_RUN	= 0,
+	RESULT_SUCCES	= 1,
+	RESULT_ERROR	= 2
+};
+
 class Operation
 {
-	
+	//Copy of a device shared by all operations queued on it since it was scanned
+	struct DeviceSnapshot
+	{
+		Device device ;
+
+		DeviceSnapshot( const Device & device ) ;
+		void reference() const ;
+		void unreference() const ;
+
+		mutable volatile gint ref_count ;
+	} ;
+
+	static Glib::RefPtr<DeviceSnapshot> get_device_snapshot( const Device & device ) ;
+
+	//Current snapshot of each device, by path.  Not a reference, so a snapshot is
+	//  removed when the last operation using it is deleted.
+	static std::map< Glib::ustring, DeviceSnapshot * > device_snapshots ;
+
+	Glib::RefPtr<DeviceSnapshot> snapshot ;
+
 public:
-	Operation() ;
+	Operation( const Device & device ) ;
 	virtual ~Operation() {}
 	
 	virtual void apply_to_visual( std::vector<Partition> & partitions ) = 0 ;
 	virtual void create_description() = 0 ;
 
 	//public variables
-	Device device ;
+	const Device & device ;
 	OperationType type ;
 	Partition partition_original ; 
 	Partition partition_new ;
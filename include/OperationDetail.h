@@ -51,17 +51,22 @@ public:
 	OperationDetail( const Glib::ustring & description,
 			 OperationDetailStatus status = STATUS_EXECUTE,
 			 Font font = FONT_NORMAL ) ;
+	OperationDetail( const OperationDetail & other ) ;
+	OperationDetail & operator=( const OperationDetail & other ) ;
+	~OperationDetail() ;
 	void set_description( const Glib::ustring & description, Font font = FONT_NORMAL ) ;
-	Glib::ustring get_description() const ;
+	const Glib::ustring & get_description() const ;
 	void set_status( OperationDetailStatus status ) ;
 	OperationDetailStatus get_status() const ;
+	void set_progress( double fraction, const Glib::ustring & progress_text ) ;
 	void set_treepath( const Glib::ustring & treepath ) ;
-	Glib::ustring get_treepath() const ;
+	const Glib::ustring & get_treepath() const ;
 	Glib::ustring get_elapsed_time() const ;
 	
 	void add_child( const OperationDetail & operationdetail ) ;
-	std::vector<OperationDetail> & get_childs() ;
-	const std::vector<OperationDetail> & get_childs() const ;
+	void add_child_output( const Glib::ustring & output ) ;
+	const std::vector<OperationDetail *> & get_childs() const ;
+	const Glib::ustring & get_log_file() const ;
 	OperationDetail & get_last_child() ;
 
 	double fraction ;
@@ -77,8 +82,19 @@ private:
 
 	Glib::ustring treepath ;
 	
-	std::vector<OperationDetail> sub_details ; 	
+	//Children are allocated individually and owned by their parent, so appending
+	//  never moves existing subtrees and references to them stay valid
+	OperationDetail * parent ;
+	std::vector<OperationDetail *> sub_details ; 	
 	std::time_t time_start, time_elapsed ;
+
+	//File holding the complete text of a large command output, of which only the
+	//  start and end are kept in the description.  Kept until the program exits,
+	//  as copies of the detail refer to it too.
+	Glib::ustring log_file ;
+
+	void copy_children( const OperationDetail & other ) ;
+	void delete_children() ;
 };
 
 } //GParted
@@ -0,0 +1,86 @@
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+/* OperationPlanner
+ *
+ * Rewrites the queue of pending operations into an equivalent plan which moves
+ * less data, before it is applied.  Win_GParted::Merge_Operations() only merges
+ * neighbouring operations as they are added.  The planner also finds:
+ *
+ *   - a partition moved twice with other operations in between, which is
+ *     moved once, at any point between the two moves where that is possible
+ *   - a partition moved and later deleted, which is deleted where it is
+ *
+ * Every candidate plan is checked by simulating the partition layout of each
+ * disk, step by step.  A plan in which partitions would overlap, or a logical
+ * partition would lie outside the extended partition, is rejected.
+ */
+
+#ifndef OPERATION_PLANNER_H_
+#define OPERATION_PLANNER_H_
+
+#include "../include/Operation.h"
+
+namespace GParted
+{
+
+class OperationPlanner
+{
+public:
+	OperationPlanner( const std::vector<Operation *> & operations ) ;
+
+	bool optimize() ;
+	Byte_Value get_queued_bytes() const ;
+	Byte_Value get_planned_bytes() const ;
+	unsigned int get_removed_operations() const ;
+	void apply( std::vector<Operation *> & operations ) const ;
+
+private:
+	//An operation with the partitions it will be applied with
+	struct Step
+	{
+		Operation * operation ;
+		Partition partition_original ;
+		Partition partition_new ;
+	} ;
+
+	//Space taken by a partition on a disk
+	struct Extent
+	{
+		Glib::ustring device_path ;
+		Sector sector_start ;
+		Sector sector_end ;
+		PartitionType type ;
+	} ;
+
+	bool collapse_moves( std::vector<Step> & plan ) const ;
+	bool drop_move_before_delete( std::vector<Step> & plan ) const ;
+	int find_next_step( const std::vector<Step> & plan, unsigned int index ) const ;
+	bool is_valid( const std::vector<Step> & plan ) const ;
+	static bool apply_step( const Step & step, std::vector<Extent> & extents ) ;
+	static bool layout_valid( const std::vector<Extent> & extents ) ;
+	static bool same_place( const Partition & first, const Partition & second ) ;
+	static Byte_Value get_bytes_moved( const Step & step ) ;
+	static Byte_Value get_bytes_moved( const std::vector<Step> & plan ) ;
+
+	std::vector<Step> queued ;
+	std::vector<Step> plan ;
+	std::vector<Extent> initial_extents ;
+};
+
+}//GParted
+
+#endif /* OPERATION_PLANNER_H_ */
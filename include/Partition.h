@@ -26,6 +26,8 @@
 
 #include "../include/Utils.h"
 
+#include <glibmm/refptr.h>
+
 namespace GParted
 {
 	
@@ -93,13 +95,13 @@ public:
 	void add_paths( const std::vector<Glib::ustring> & paths, bool clear_paths = false ) ;
 	Byte_Value get_byte_length() const ;
 	Sector get_sector_length() const ; 
-	Glib::ustring get_path() const ;
-	std::vector<Glib::ustring> get_paths() const ;
+	const Glib::ustring & get_path() const ;
+	const std::vector<Glib::ustring> & get_paths() const ;
 	void add_mountpoint( const Glib::ustring & mountpoint, bool clear_mountpoints = false ) ;
 	void add_mountpoints( const std::vector<Glib::ustring> & mountpoints, bool clear_mountpoints = false ) ;
-	Glib::ustring get_mountpoint() const ; 
+	const Glib::ustring & get_mountpoint() const ; 
 	void clear_mountpoints() ;
-	std::vector<Glib::ustring> get_mountpoints() const ;
+	const std::vector<Glib::ustring> & get_mountpoints() const ;
 	Sector get_sector() const ;
 	bool test_overlap( const Partition & partition ) const ;
 	bool label_known() const ;
@@ -144,13 +146,32 @@ public:
 private:
 	static void get_usage_triple_helper( Sector stot, Sector s1, Sector s2, Sector s3, int imax, int & i1, int & i2, int & i3 ) ;
 
-	void sort_paths_and_remove_duplicates() ;
+	static void sort_paths_and_remove_duplicates( std::vector<Glib::ustring> & paths ) ;
 	Sector calc_significant_unallocated_sectors() const ;
 
 	static bool compare_paths( const Glib::ustring & A, const Glib::ustring & B ) ;
 	
-	std::vector<Glib::ustring> paths ;
-	std::vector<Glib::ustring> mountpoints ;
+	//Paths and mount points are shared between copies of a partition and only
+	//  duplicated when a copy changes them, so copying a partition is cheap
+	struct Names
+	{
+		std::vector<Glib::ustring> paths ;
+		std::vector<Glib::ustring> mountpoints ;
+
+		Names() ;
+		Names( const Names & other ) ;
+		void reference() const ;
+		void unreference() const ;
+
+		mutable volatile gint ref_count ;
+
+	private:
+		Names & operator=( const Names & other ) ;
+	} ;
+
+	Names & get_names_for_write() ;
+
+	Glib::RefPtr<Names> names ;
 	bool have_label ;
 	Glib::ustring label ;
 };
@@ -19,7 +19,8 @@
 /* Proc_Partitions_Info
  * 
  * A persistent cache of information from the file /proc/partitions
- * that helps to minimize the number of required disk reads.
+ * that helps to minimize the number of required disk reads.  It may be
+ * used by several threads at once.
  */
 
 #ifndef PROC_PARTITONS_INFO_H_
@@ -27,6 +28,8 @@
 
 #include "../include/Utils.h"
 
+#include <glibmm/thread.h>
+
 namespace GParted
 {
 
@@ -38,11 +41,16 @@ public:
 	~Proc_Partitions_Info() ;
 	std::vector<Glib::ustring> get_device_paths() ;
 	std::vector<Glib::ustring> get_alternate_paths( const Glib::ustring & path ) ;
+	std::vector<Glib::ustring> get_multipath_members( const Glib::ustring & path ) ;
 private:
 	void load_proc_partitions_info_cache() ;
+	static bool is_whole_disk_name( const std::string & name ) ;
+	static void collapse_multipath_devices( const std::vector<Glib::ustring> & dm_names ) ;
+	static Glib::Mutex mutex ;
 	static bool proc_partitions_info_cache_initialized ;
 	static std::vector<Glib::ustring> device_paths_cache ;
 	static std::map< Glib::ustring, Glib::ustring > alternate_paths_cache ;
+	static std::map< Glib::ustring, std::vector<Glib::ustring> > multipath_members_cache ;
 };
 
 }//GParted
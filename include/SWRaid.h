@@ -28,6 +28,7 @@
 
 #include "../include/Utils.h"
 
+#include <glibmm/thread.h>
 #include <vector>
 
 namespace GParted
@@ -44,7 +45,8 @@ public:
 	void get_devices( std::vector<Glib::ustring> & swraid_devices ) ;
 private:
 	void load_swraid_cache() ;
-	void set_commands_found() ;
+	bool set_commands_found() ;
+	static Glib::Mutex mutex ;
 	static bool swraid_cache_initialized ;
 	static bool mdadm_found ;
 	static std::vector<Glib::ustring> swraid_devices ;
@@ -0,0 +1,80 @@
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+/* ThroughputModel
+ *
+ * Remembers how fast the disks read and write data and how long the file system
+ * commands took, to predict how long the pending operations take.  Disk
+ * throughput is kept per disk model and size, so it also applies after the disk
+ * got another device name.  File system commands are kept per action and file
+ * system, e.g. "check" of ext4, relative to the size of the partition.
+ *
+ * Each measurement is added to a decaying sum, so recent measurements count most.
+ * The history is stored in $XDG_CACHE_HOME/gparted/throughput by save(), once
+ * the operations are applied.  Without history conservative defaults are used.
+ */
+
+#ifndef THROUGHPUT_MODEL_H_
+#define THROUGHPUT_MODEL_H_
+
+#include "../include/Utils.h"
+
+#include <glibmm/thread.h>
+#include <map>
+
+namespace GParted
+{
+
+class ThroughputModel
+{
+public:
+	static void add_device( const Glib::ustring & device_path, const Glib::ustring & model, Sector length ) ;
+	static void record_read( const Glib::ustring & device_path, Byte_Value bytes, double seconds ) ;
+	static void record_copy( const Glib::ustring & dst_device_path, Byte_Value bytes, double seconds ) ;
+	static void record_command( const Glib::ustring & action, FILESYSTEM filesystem,
+	                            Byte_Value bytes, double seconds ) ;
+	static double estimate_read( const Glib::ustring & device_path, Byte_Value bytes ) ;
+	static double estimate_copy( const Glib::ustring & src_device_path,
+	                             const Glib::ustring & dst_device_path,
+	                             Byte_Value bytes ) ;
+	static double estimate_command( const Glib::ustring & action, FILESYSTEM filesystem, Byte_Value bytes ) ;
+	static void save() ;
+
+private:
+	struct History
+	{
+		double seconds ;
+		double bytes ;
+		double count ;
+	} ;
+
+	static void record( const Glib::ustring & key, Byte_Value bytes, double seconds ) ;
+	static double estimate( const Glib::ustring & key, Byte_Value bytes ) ;
+	static Glib::ustring get_device_key( const Glib::ustring & kind, const Glib::ustring & device_path ) ;
+	static void load() ;
+	static bool owned_by_user( const std::string & path ) ;
+	static Glib::ustring get_filename() ;
+
+	static Glib::Mutex mutex ;
+	static bool loaded ;
+	static bool changed ;	//measurements not saved yet
+	static std::map<Glib::ustring, History> history ;
+	static std::map<Glib::ustring, Glib::ustring> device_ids ;	//device path to model and size
+};
+
+}//GParted
+
+#endif /* THROUGHPUT_MODEL_H_ */
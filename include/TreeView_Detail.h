@@ -49,7 +49,9 @@ private:
 	void load_partitions( const std::vector<Partition> & partitions,
 			      bool & mountpoints,
 			      bool & labels,
+			      bool & changed,
 			      const Gtk::TreeRow & parent_row = Gtk::TreeRow() ) ;
+	static bool same_details( const Partition & partition_a, const Partition & partition_b ) ;
 	bool set_selected( Gtk::TreeModel::Children rows, const Partition & partition, bool inside_extended = false ) ;
 	void create_row( const Gtk::TreeRow & treerow, const Partition & partition );
 
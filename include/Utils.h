@@ -170,6 +170,16 @@ public:
 				    Glib::ustring & output,
 				    Glib::ustring & error,
 				    bool use_C_locale = false ) ;
+	static int execute_command_streamed( const Glib::ustring & command,
+	                                     Glib::ustring & output,
+	                                     Glib::ustring & error,
+	                                     const sigc::slot<void, const std::string &> & slot_progress,
+	                                     bool use_C_locale = false ) ;
+	static bool lock_operations() ;
+	static void relock_operations() ;
+	static void unlock_operations() ;
+	static bool release_operations_lock() ;
+	static void set_operations_cancelled( bool cancelled ) ;
 	static Glib::ustring regexp_label( const Glib::ustring & text
 	                                 , const Glib::ustring & pattern
 	                                 ) ;
@@ -54,7 +54,8 @@ private:
 	void init_hpaned_main() ;
 
 	void refresh_combo_devices( unsigned int current_device ) ;
-	void show_pulsebar( const Glib::ustring & status_message ) ;
+	void show_pulsebar( const Glib::ustring & status_message,
+	                    const sigc::slot<void> & slot_pulse = sigc::slot<void>() ) ;
 	
 	//Fill txtview_device_info_buffer with some information about the selected device
 	void Fill_Label_Device_Info();
@@ -126,13 +127,22 @@ private:
 	}
 		
 	//threads..
-	void thread_refresh_devices() ;
+	void thread_refresh_devices( Glib::ustring first_device_path ) ;
+	void add_scanned_devices() ;
 	void thread_unmount_partition( bool * succes, Glib::ustring * error ) ;
 	void thread_mount_partition( Glib::ustring mountpoint, bool * succes, Glib::ustring * error ) ;
 	void thread_toggle_swap( bool * succes, Glib::ustring * error ) ;
 	void thread_toggle_lvm2_pv( bool * succes, Glib::ustring * error ) ;
 	void thread_toggle_luks( bool * success, Glib::ustring * error ) ;
 	void thread_guess_partition_table();
+	void thread_read_device_details( Glib::ustring device_path, bool * success ) ;
+	void thread_prefetch_device_details( std::vector<Glib::ustring> device_paths ) ;
+
+	//reading device details in the background
+	void read_selected_device_details() ;
+	void start_prefetch() ;
+	void stop_prefetch() ;
+	bool merge_prefetched_devices() ;
 		
 	//signal handlers
 	void open_operationslist() ;
@@ -177,6 +187,7 @@ private:
 	
 	void activate_undo();
 	void remove_operation( int index = -1, bool remove_all = false ) ;
+	void invalidate_visual_snapshots( unsigned int index ) ;
 	int  partition_in_operation_queue_count( const Partition & partition ) ;
 	int  active_partitions_on_device_count( const Device & device ) ;
 	void activate_apply();
@@ -190,8 +201,18 @@ private:
 //private variables
 	Partition selected_partition, copied_partition;
 	std::vector<Device> devices;
+	std::vector<Device> scanned_devices ;	//complete result of thread_refresh_devices()
+	bool showing_scanned_devices ;		//devices holds the ones scanned so far
 	std::vector<Operation *> operations;
 
+	//Partition layout of the selected device after some of the queued operations on
+	//  it, by operation index, so that Refresh_Visual() only has to replay operations
+	//  added since the last refresh.  Only every few operations a snapshot is kept,
+	//  besides the latest one, to limit memory use with long queues.
+	Glib::ustring visual_device_path ;
+	std::vector<Operation *> visual_operations ;
+	std::vector< std::pair< unsigned int, std::vector<Partition> > > visual_snapshots ;
+
 //gui stuff
 	Gtk::HPaned hpaned_main;
 	Gtk::VPaned vpaned_main;
@@ -267,6 +288,15 @@ private:
 	//stuff for progress overview and pulsebar
 	Glib::Thread *thread ;
 	bool pulse ;
+	Device detailed_device ;	//result of thread_read_device_details()
+
+	//devices read in detail by the prefetch thread, merged by the main thread
+	Glib::Thread *prefetch_thread ;
+	bool prefetch_stop ;
+	bool prefetch_done ;
+	Glib::Mutex prefetch_mutex ;
+	std::vector<Device> prefetched_devices ;
+	sigc::connection prefetch_connection ;
 };
 
 } //GParted
@@ -0,0 +1,74 @@
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#include "../include/CoreSession.h"
+#include "../include/FileSystem.h"
+
+namespace GParted
+{
+
+//Initialize static data elements
+pthread_once_t CoreSession::key_once = PTHREAD_ONCE_INIT ;
+pthread_key_t CoreSession::key ;
+
+//Make the new session the current one of the calling thread
+CoreSession::CoreSession()
+{
+	table_session = false ;
+	thread_default = false ;
+
+	pthread_once( & key_once, create_key ) ;
+	previous = static_cast<CoreSession *>( pthread_getspecific( key ) ) ;
+	pthread_setspecific( key, this ) ;
+}
+
+CoreSession::~CoreSession()
+{
+	pthread_setspecific( key, previous ) ;
+
+	std::map< FILESYSTEM, FileSystem * >::iterator iter ;
+	for ( iter = filesystems .begin() ; iter != filesystems .end() ; ++iter )
+		delete iter ->second ;
+}
+
+//The current session of the calling thread
+CoreSession & CoreSession::get()
+{
+	pthread_once( & key_once, create_key ) ;
+	CoreSession * session = static_cast<CoreSession *>( pthread_getspecific( key ) ) ;
+	if ( session )
+		return * session ;
+
+	//registers itself as the session of the thread
+	session = new CoreSession() ;
+	session ->thread_default = true ;
+	return * session ;
+}
+
+void CoreSession::create_key()
+{
+	pthread_key_create( & key, on_thread_exit ) ;
+}
+
+//Called with the current session of an exiting thread.  Sessions on its stack
+//  are gone by then, so only the one created by get() is left.
+void CoreSession::on_thread_exit( void * session )
+{
+	CoreSession * core_session = static_cast<CoreSession *>( session ) ;
+	if ( core_session ->thread_default )
+		delete core_session ;
+}
+
+}//GParted
@@ -23,37 +23,32 @@ namespace GParted
 {
 
 //Initialize static data elements
+Glib::Mutex DMRaid::mutex ;
 bool DMRaid::dmraid_cache_initialized = false ;
 bool DMRaid::dmraid_found  = false ;
 bool DMRaid::dmsetup_found = false ;
 bool DMRaid::udevinfo_found = false ;
 bool DMRaid::udevadm_found  = false ;
-std::vector<Glib::ustring> DMRaid::dmraid_devices ;
+std::vector<Glib::ustring> DMRaid::dmraid_devices_cache ;
 
 DMRaid::DMRaid()
 {
 	//Ensure that cache has been loaded at least once
-	if ( ! dmraid_cache_initialized )
-	{
-		dmraid_cache_initialized = true ;
-		set_commands_found() ;
+	if ( set_commands_found() )
 		load_dmraid_cache() ;
-	}
+
+	Glib::Mutex::Lock lock( mutex ) ;
+	dmraid_devices = dmraid_devices_cache ;
 }
 
 DMRaid::DMRaid( const bool & do_refresh )
 {
 	//Ensure that cache has been loaded at least once
-	if ( ! dmraid_cache_initialized )
-	{
-		dmraid_cache_initialized = true ;
-		set_commands_found() ;
-		if ( do_refresh == false )
-			load_dmraid_cache() ;
-	}
-
-	if ( do_refresh )
+	if ( set_commands_found() || do_refresh )
 		load_dmraid_cache() ;
+
+	Glib::Mutex::Lock lock( mutex ) ;
+	dmraid_devices = dmraid_devices_cache ;
 }
 
 DMRaid::~DMRaid()
@@ -62,9 +57,10 @@ DMRaid::~DMRaid()
 
 void DMRaid::load_dmraid_cache()
 {
-	//Load data into dmraid structures
+	//Load data into dmraid structures.  The command runs without holding the
+	//  lock, so other threads can use the old list meanwhile.
 	Glib::ustring output, error ;
-	dmraid_devices .clear() ;
+	std::vector<Glib::ustring> devices ;
 
 	if ( dmraid_found )
 	{
@@ -72,18 +68,27 @@ void DMRaid::load_dmraid_cache()
 		{
 			Glib::ustring temp = Utils::regexp_label( output, "^(no raid disks).*" ) ;
 			if ( temp != "no raid disks" )
-				Utils::tokenize( output, dmraid_devices, "\n" ) ;
+				Utils::tokenize( output, devices, "\n" ) ;
 		}
 	}
+
+	Glib::Mutex::Lock lock( mutex ) ;
+	dmraid_devices_cache .swap( devices ) ;
 }
 
-void DMRaid::set_commands_found()
+//Set status of commands found, the first time only.  Returns whether it did.
+bool DMRaid::set_commands_found()
 {
-	//Set status of commands found 
+	Glib::Mutex::Lock lock( mutex ) ;
+	if ( dmraid_cache_initialized )
+		return false ;
+
+	dmraid_cache_initialized = true ;
 	dmraid_found = (! Glib::find_program_in_path( "dmraid" ) .empty() ) ;
 	dmsetup_found = (! Glib::find_program_in_path( "dmsetup" ) .empty() ) ;
 	udevinfo_found = (! Glib::find_program_in_path( "udevinfo" ) .empty() ) ;
 	udevadm_found = (! Glib::find_program_in_path( "udevadm" ) .empty() ) ;
+	return true ;
 }
 
 bool DMRaid::is_dmraid_supported()
@@ -153,10 +158,10 @@ int DMRaid::execute_command( const Glib::ustring & command, OperationDetail & op
 	int exit_status = Utils::execute_command( "nice -n 19 " + command, output, error ) ;
 
 	if ( ! output .empty() )
-		operationdetail .get_last_child() .add_child( OperationDetail( output, STATUS_NONE, FONT_ITALIC ) ) ;
+		operationdetail .get_last_child() .add_child_output( output ) ;
 	
 	if ( ! error .empty() )
-		operationdetail .get_last_child() .add_child( OperationDetail( error, STATUS_NONE, FONT_ITALIC ) ) ;
+		operationdetail .get_last_child() .add_child_output( error ) ;
 
 	return exit_status ;
 }
@@ -18,9 +18,19 @@
  
 #include "../include/Device.h"
 
+#include <glibmm/thread.h>
+
 namespace GParted
 {
 
+unsigned int Device::next_generation = 0 ;
+
+//Devices are reset by scanning threads as well as the main thread
+static Glib::Mutex generation_mutex ;
+
+//Returned by get_path() for a device without any paths
+const Glib::ustring NO_DEVICE_PATH ;
+
 Device::Device()
 {
 	Reset() ;	
@@ -35,6 +45,9 @@ void Device::Reset()
 	model = disktype = "" ;
 	sector_size = max_prims = highest_busy = 0 ;
 	readonly = false ; 	
+	details_known = false ;
+	Glib::Mutex::Lock lock( generation_mutex ) ;
+	generation = ++next_generation ;
 }
 	
 void Device::add_path( const Glib::ustring & path, bool clear_paths )
@@ -57,15 +70,32 @@ void Device::add_paths( const std::vector<Glib::ustring> & paths, bool clear_pat
 	sort_paths_and_remove_duplicates() ;
 }
 
-Glib::ustring Device::get_path() const
+//Add paths the device is also reached through, like the paths a multipath device
+//  is built on, while keeping the current path as the one used to access it
+void Device::add_member_paths( const std::vector<Glib::ustring> & paths )
+{
+	if ( this ->paths .empty() || paths .empty() )
+	{
+		add_paths( paths ) ;
+		return ;
+	}
+
+	Glib::ustring path = this ->paths .front() ;
+	add_paths( paths ) ;
+
+	std::vector<Glib::ustring>::iterator iter = std::find( this ->paths .begin(), this ->paths .end(), path ) ;
+	std::rotate( this ->paths .begin(), iter, iter + 1 ) ;
+}
+
+const Glib::ustring & Device::get_path() const
 {
 	if ( paths .size() > 0 )
 		return paths .front() ;
 
-	return "" ;
+	return NO_DEVICE_PATH ;
 }
 	
-std::vector<Glib::ustring> Device::get_paths() const
+const std::vector<Glib::ustring> & Device::get_paths() const
 {
 	return paths ;
 }
@@ -0,0 +1,224 @@
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#include "../include/DeviceFilter.h"
+
+#include <fstream>
+#include <cstdlib>
+#include <climits>
+
+namespace GParted
+{
+
+//Initialize static data elements
+std::vector<DeviceFilter::Rule> DeviceFilter::rules ;
+bool DeviceFilter::have_include_rules = false ;
+
+//Add one rule, like "exclude loop*".  Returns false for a rule which can't be parsed.
+bool DeviceFilter::add_rule( const Glib::ustring & rule_text )
+{
+	Glib::ustring text = Utils::trim( rule_text ) ;
+	Glib::ustring::size_type space = text .find_first_of( " \t" ) ;
+	if ( space == Glib::ustring::npos )
+		return false ;
+	Glib::ustring keyword = text .substr( 0, space ) ;
+	Glib::ustring argument = Utils::trim( text .substr( space ) ) ;
+	if ( argument .empty() )
+		return false ;
+
+	Rule rule ;
+	rule .match_name = false ;
+	try
+	{
+		if ( keyword == "include" || keyword == "exclude" )
+		{
+			rule .type = keyword == "include" ? RULE_INCLUDE : RULE_EXCLUDE ;
+			rule .match_name = argument[ 0 ] != '/' ;
+			rule .regex = Glib::Regex::create( glob_to_regex( argument ) ) ;
+		}
+		else if ( keyword == "include-regex" || keyword == "exclude-regex" )
+		{
+			rule .type = keyword == "include-regex" ? RULE_INCLUDE : RULE_EXCLUDE ;
+			rule .regex = Glib::Regex::create( argument ) ;
+		}
+		else if ( keyword == "require" )
+		{
+			Glib::ustring::size_type op = argument .find_first_of( "=!<>" ) ;
+			if ( op == Glib::ustring::npos || op == 0 )
+				return false ;
+			Glib::ustring::size_type op_length = argument .substr( op + 1, 1 ) == "=" ? 2 : 1 ;
+
+			rule .type = RULE_REQUIRE ;
+			rule .attribute = Utils::trim( argument .substr( 0, op ) ) ;
+			rule .comparison = argument .substr( op, op_length ) ;
+			rule .value = Utils::trim( argument .substr( op + op_length ) ) ;
+			if ( rule .comparison == "!" || rule .value .empty() )
+				return false ;
+		}
+		else
+			return false ;
+	}
+	catch ( Glib::Error & e )
+	{
+		return false ;
+	}
+
+	if ( rule .type == RULE_INCLUDE )
+		have_include_rules = true ;
+	rules .push_back( rule ) ;
+	return true ;
+}
+
+//Add the rules from a file, one per line.  Empty lines and lines starting with '#'
+//  are ignored.  A missing file means no rules.
+void DeviceFilter::load_rules( const Glib::ustring & filename )
+{
+	std::ifstream file( filename .c_str() ) ;
+	if ( ! file )
+		return ;
+
+	std::string line ;
+	for ( unsigned int line_number = 1 ; getline( file, line ) ; line_number++ )
+	{
+		Glib::ustring text = Utils::trim( line ) ;
+		if ( text .empty() || text[ 0 ] == '#' )
+			continue ;
+
+		if ( ! add_rule( text ) )
+			std::cout << filename << ":" << line_number << ": ignoring invalid device filter rule \""
+			          << text << "\"" << std::endl ;
+	}
+}
+
+//Decide whether a device is scanned.  Called before libparted opens the device,
+//  so it only looks at the path and at sysfs.
+bool DeviceFilter::accept( const Glib::ustring & device_path )
+{
+	if ( rules .empty() )
+		return true ;
+
+	Glib::ustring name = get_kernel_name( device_path ) ;
+	bool included = ! have_include_rules ;
+	for ( unsigned int t = 0 ; t < rules .size() ; t++ )
+	{
+		switch ( rules[ t ] .type )
+		{
+			case RULE_INCLUDE:
+				if ( ! included && matches( rules[ t ], device_path, name ) )
+					included = true ;
+				break ;
+			case RULE_EXCLUDE:
+				if ( matches( rules[ t ], device_path, name ) )
+					return false ;
+				break ;
+			case RULE_REQUIRE:
+				if ( ! attribute_matches( rules[ t ], name ) )
+					return false ;
+				break ;
+		}
+	}
+
+	return included ;
+}
+
+//Private Methods
+bool DeviceFilter::matches( const Rule & rule, const Glib::ustring & path, const Glib::ustring & name )
+{
+	return rule .regex ->match( rule .match_name ? name : path ) ;
+}
+
+//Compare a sysfs attribute of the device.  Values which are both numbers are
+//  compared as numbers, other values only for (in)equality.  A device without
+//  the attribute doesn't match.
+bool DeviceFilter::attribute_matches( const Rule & rule, const Glib::ustring & name )
+{
+	std::ifstream file( ( "/sys/class/block/" + name + "/" + rule .attribute ) .c_str() ) ;
+	std::string line ;
+	if ( ! file || ! getline( file, line ) )
+		return false ;
+	Glib::ustring value = Utils::trim( line ) ;
+
+	char * value_end ;
+	char * wanted_end ;
+	long long number = strtoll( value .c_str(), &value_end, 0 ) ;
+	long long wanted = strtoll( rule .value .c_str(), &wanted_end, 0 ) ;
+	int order ;
+	if ( ! value .empty() && *value_end == '\0' && *wanted_end == '\0' )
+		order = number < wanted ? -1 : number > wanted ? 1 : 0 ;
+	else if ( rule .comparison == "=" || rule .comparison == "==" )
+		return value == rule .value ;
+	else if ( rule .comparison == "!=" )
+		return value != rule .value ;
+	else
+		return false ;
+
+	if ( rule .comparison == "=" || rule .comparison == "==" )
+		return order == 0 ;
+	if ( rule .comparison == "!=" )
+		return order != 0 ;
+	if ( rule .comparison == "<" )
+		return order < 0 ;
+	if ( rule .comparison == "<=" )
+		return order <= 0 ;
+	if ( rule .comparison == ">" )
+		return order > 0 ;
+	if ( rule .comparison == ">=" )
+		return order >= 0 ;
+	return false ;
+}
+
+//The name of the device in /sys/class/block, e.g. "dm-0" for /dev/mapper/vg-root
+//  and "cciss!c0d0" for /dev/cciss/c0d0
+Glib::ustring DeviceFilter::get_kernel_name( const Glib::ustring & device_path )
+{
+	char real_path[ PATH_MAX ] ;
+	Glib::ustring name = device_path ;
+	if ( realpath( device_path .c_str(), real_path ) )
+		name = real_path ;
+
+	if ( name .substr( 0, 5 ) == "/dev/" )
+		name .erase( 0, 5 ) ;
+	for ( Glib::ustring::size_type index = name .find( '/' ) ; index != Glib::ustring::npos ; index = name .find( '/' ) )
+		name .replace( index, 1, "!" ) ;
+
+	return name ;
+}
+
+//Convert a shell style wildcard pattern, matching the whole string, to a regex
+Glib::ustring DeviceFilter::glob_to_regex( const Glib::ustring & glob )
+{
+	Glib::ustring regex = "^" ;
+	for ( Glib::ustring::size_type t = 0 ; t < glob .size() ; t++ )
+	{
+		if ( glob[ t ] == '*' )
+			regex += ".*" ;
+		else if ( glob[ t ] == '?' )
+			regex += "." ;
+		else if ( glob[ t ] == '[' && glob .find( ']', t + 1 ) != Glib::ustring::npos )
+		{
+			Glib::ustring::size_type end = glob .find( ']', t + 1 ) ;
+			Glib::ustring set = glob .substr( t, end - t + 1 ) ;
+			if ( set .size() > 2 && set[ 1 ] == '!' )
+				set .replace( 1, 1, "^" ) ;
+			regex += set ;
+			t = end ;
+		}
+		else
+			regex += Glib::Regex::escape_string( glob .substr( t, 1 ) ) ;
+	}
+	return regex + "$" ;
+}
+
+}//GParted
@@ -17,15 +17,20 @@
  */
  
 #include "../include/Dialog_Progress.h"
+#include "../include/IOThrottle.h"
+#include "../include/OperationCopy.h"
 
 #include <gtkmm/stock.h>
 #include <gtkmm/main.h>
 #include <gtkmm/messagedialog.h>
 #include <gtkmm/filechooserdialog.h>
+#include <algorithm>
 
 namespace GParted
 {
 
+unsigned int Dialog_Progress::max_parallel_operations = 4 ;
+
 Dialog_Progress::Dialog_Progress( const std::vector<Operation *> & operations )
 {
 	this ->set_resizable( false ) ;
@@ -34,12 +39,19 @@ Dialog_Progress::Dialog_Progress( const std::vector<Operation *> & operations )
 	this ->operations = operations ;
 	succes = true ;
 	cancel = false ;
+	pulse = false ;
+	shown_operation = operations .size() ;	//none yet
 	warnings = 0 ;
+	completed = 0 ;
+	current_fraction = -1 ;
 
 	fraction = 1.00 / operations .size() ;
 		
-	dispatcher_update_gui_elements .connect( 
-		sigc::mem_fun( this, &Dialog_Progress::dispatcher_on_update_gui_elements ) ) ;
+	mainthread = Glib::Thread::self() ;
+	main_loop = Glib::MainLoop::create() ;
+	dispatcher_progress .connect( sigc::mem_fun( this, &Dialog_Progress::dispatcher_on_progress ) ) ;
+	dispatcher_operation_done .connect(
+		sigc::mem_fun( this, &Dialog_Progress::dispatcher_on_operation_done ) ) ;
 
 	{
 		Gtk::VBox* vbox(manage(new Gtk::VBox()));
@@ -60,6 +72,32 @@ Dialog_Progress::Dialog_Progress( const std::vector<Operation *> & operations )
 		label_current_sub.set_alignment(Gtk::ALIGN_LEFT);
 		vbox->pack_start(label_current_sub, Gtk::PACK_SHRINK);
 
+		//limits for the data moved, which can be changed while the operations run
+		Byte_Value bytes_per_second ;
+		unsigned int ios_per_second ;
+		IOThrottle::get_limits( bytes_per_second, ios_per_second ) ;
+
+		Gtk::HBox* hbox_limits(manage(new Gtk::HBox(false, 5)));
+		hbox_limits->pack_start(*Utils::mk_label(_("Limit I/O to")), Gtk::PACK_SHRINK);
+		spinbutton_bandwidth.set_range(0, 100000);
+		spinbutton_bandwidth.set_increments(1, 10);
+		spinbutton_bandwidth.set_numeric(true);
+		spinbutton_bandwidth.set_value(bytes_per_second / MEBIBYTE);
+		spinbutton_bandwidth.signal_value_changed().connect(
+			sigc::mem_fun(*this, &Dialog_Progress::on_limits_changed) );
+		hbox_limits->pack_start(spinbutton_bandwidth, Gtk::PACK_SHRINK);
+		/*TO TRANSLATORS: looks like  Limit I/O to [ 20 ] MiB/s and [ 0 ] operations/s (0 = no limit) */
+		hbox_limits->pack_start(*Utils::mk_label(_("MiB/s and")), Gtk::PACK_SHRINK);
+		spinbutton_iops.set_range(0, 1000000);
+		spinbutton_iops.set_increments(10, 100);
+		spinbutton_iops.set_numeric(true);
+		spinbutton_iops.set_value(ios_per_second);
+		spinbutton_iops.signal_value_changed().connect(
+			sigc::mem_fun(*this, &Dialog_Progress::on_limits_changed) );
+		hbox_limits->pack_start(spinbutton_iops, Gtk::PACK_SHRINK);
+		hbox_limits->pack_start(*Utils::mk_label(_("operations/s (0 = no limit)")), Gtk::PACK_SHRINK);
+		vbox->pack_start(*hbox_limits, Gtk::PACK_SHRINK);
+
 		vbox->pack_start(*Utils::mk_label("<b>" + Glib::ustring(_("Completed Operations:")) + "</b>"),
 					Gtk::PACK_SHRINK);
 		vbox->pack_start(progressbar_all, Gtk::PACK_SHRINK);
@@ -118,17 +156,58 @@ Dialog_Progress::Dialog_Progress( const std::vector<Operation *> & operations )
 
 void Dialog_Progress::on_signal_update( const OperationDetail & operationdetail ) 
 {
-	Gtk::TreeModel::iterator iter = treestore_operations ->get_iter( operationdetail .get_treepath() ) ;
+	ProgressUpdate update ;
+	update .treepath      = operationdetail .get_treepath() ;
+	update .description   = operationdetail .get_description() ;
+	update .elapsed_time  = operationdetail .get_elapsed_time() ;
+	update .status        = operationdetail .get_status() ;
+	update .fraction      = operationdetail .fraction ;
+	update .progress_text = operationdetail .progress_text ;
+
+	if ( Glib::Thread::self() == mainthread )
+	{
+		update_row( update ) ;
+		update_gui_elements() ;
+		return ;
+	}
+
+	//The operation thread never touches the GUI.  It queues the update, replacing
+	//  any queued update of the same row which the GUI hasn't picked up yet, and
+	//  only wakes the main thread when the queue was empty.
+	if ( cancel )
+		return ;
+
+	bool wakeup ;
+	{
+		Glib::Mutex::Lock lock( progress_mutex ) ;
+		wakeup = progress_updates .empty() ;
+		std::map<Glib::ustring, unsigned int>::iterator iter = progress_update_indexes .find( update .treepath ) ;
+		if ( iter != progress_update_indexes .end() )
+			progress_updates[ iter ->second ] = update ;
+		else
+		{
+			progress_update_indexes[ update .treepath ] = progress_updates .size() ;
+			progress_updates .push_back( update ) ;
+		}
+	}
+
+	if ( wakeup )
+		dispatcher_progress() ;
+}
+
+void Dialog_Progress::update_row( const ProgressUpdate & update ) 
+{
+	Gtk::TreeModel::iterator iter = treestore_operations ->get_iter( update .treepath ) ;
 
 	//i added the second check after get_iter() in gtk+-2.10 seems to behave differently from gtk+-2.8 
-	if ( iter && treestore_operations ->get_string( iter ) == operationdetail .get_treepath() )
+	if ( iter && treestore_operations ->get_string( iter ) == update .treepath )
 	{
 		Gtk::TreeRow treerow = *iter ;
 
-		treerow[ treeview_operations_columns .operation_description ] = operationdetail .get_description() ;
-		treerow[ treeview_operations_columns .elapsed_time ] = operationdetail .get_elapsed_time() ;
+		treerow[ treeview_operations_columns .operation_description ] = update .description ;
+		treerow[ treeview_operations_columns .elapsed_time ] = update .elapsed_time ;
 
-		switch ( operationdetail .get_status() )
+		switch ( update .status )
 		{
 			case STATUS_EXECUTE:
 				treerow[ treeview_operations_columns .status_icon ] = icon_execute ;
@@ -152,83 +231,275 @@ void Dialog_Progress::on_signal_update( const OperationDetail & operationdetail
 				break ;
 		}
 
-		pulse = operationdetail .fraction < 0 ;
-
-		//update the gui elements..
-		this ->operationdetail = operationdetail ;
+		//the gui elements show the progress of one of the running operations
+		if ( update .treepath .substr( 0, update .treepath .find( ':' ) ) == Utils::num_to_str( shown_operation ) )
+		{
+			pulse = update .fraction < 0 ;
 
-		if ( operationdetail .get_status() == STATUS_EXECUTE )
-			label_current_sub_text = operationdetail .get_description() ;
+			//remember what to show in the gui elements..
+			current_fraction = update .fraction ;
+			current_progress_text = update .progress_text ;
 
-		dispatcher_update_gui_elements() ;
+			if ( update .status == STATUS_EXECUTE )
+				label_current_sub_text = update .description ;
+		}
 	}
 	else//it's an new od which needs to be added to the model.
 	{
-		unsigned int pos = operationdetail .get_treepath() .rfind( ":" ) ;
-		if ( pos < operationdetail .get_treepath() .length() )
-			iter = treestore_operations ->get_iter( operationdetail .get_treepath() 
-							.substr( 0, operationdetail .get_treepath() .rfind( ":" ) ) ) ;
+		unsigned int pos = update .treepath .rfind( ":" ) ;
+		if ( pos < update .treepath .length() )
+			iter = treestore_operations ->get_iter( update .treepath .substr( 0, pos ) ) ;
 		else
-			iter = treestore_operations ->get_iter( operationdetail .get_treepath() ) ;
+			iter = treestore_operations ->get_iter( update .treepath ) ;
 
 		if ( iter)
 		{
 			treestore_operations ->append( static_cast<Gtk::TreeRow>( *iter) .children() ) ;
-			on_signal_update( operationdetail ) ;
+			update_row( update ) ;
 		}
 	}
 }
 
-void Dialog_Progress::dispatcher_on_update_gui_elements()
+void Dialog_Progress::update_gui_elements()
 {
 	label_current_sub .set_markup( "<i>" + label_current_sub_text + "</i>\n" ) ;
 	
-	if ( operationdetail .fraction >= 0 )
-		progressbar_current .set_fraction( operationdetail .fraction > 1.0 ? 1.0 : operationdetail .fraction ) ;
+	if ( current_fraction >= 0 )
+		progressbar_current .set_fraction( current_fraction > 1.0 ? 1.0 : current_fraction ) ;
 
 	//To ensure progress bar height remains the same, add a space in case message is empty
-	progressbar_current .set_text( operationdetail .progress_text + " " ) ;
+	progressbar_current .set_text( current_progress_text + " " ) ;
+
+	update_progress_all() ;
+
+	//only keep a timer running while there is something to pulse
+	if ( pulse && ! pulse_connection .connected() )
+		pulse_connection = Glib::signal_timeout() .connect(
+			sigc::mem_fun( this, &Dialog_Progress::on_pulse_timeout ), 100 ) ;
 }
 
-void Dialog_Progress::on_signal_show()
+void Dialog_Progress::update_progress_all()
 {
-	for ( t = 0 ; t < operations .size() && succes && ! cancel ; t++ )
+	//not before the operations are started
+	if ( estimates .size() != operations .size() )
+		return ;
+
+	Glib::ustring text = String::ucompose( _("%1 of %2 operations completed"), completed, operations .size() ) ;
+	if ( completed < operations .size() )
+		/*TO TRANSLATORS: looks like  1 of 3 operations completed (about 00:12:30 remaining) */
+		text = String::ucompose( _("%1 (about %2 remaining)"),
+		                         text, Utils::format_time( Utils::round( get_remaining_time() ) ) ) ;
+	progressbar_all .set_text( text ) ;
+	progressbar_all .set_fraction( fraction * completed > 1.0 ? 1.0 : fraction * completed ) ;
+}
+
+//Predict when the last operation finishes.  An operation starts once the operations
+//  it waits for are done.  Running operations take what is left of their estimate.
+double Dialog_Progress::get_remaining_time()
+{
+	double now = timer_total .elapsed() ;
+	std::vector<double> finish( operations .size(), 0 ) ;
+	double remaining_time = 0 ;
+	for ( unsigned int i = 0 ; i < operations .size() ; i++ )
 	{
-		operations[ t ] ->operation_detail .signal_update .connect(
-			sigc::mem_fun( this, &Dialog_Progress::on_signal_update ) ) ;
+		double remaining = 0 ;
+		if ( states[ i ] == STATE_RUNNING )
+			remaining = std::max( estimates[ i ] - ( now - start_times[ i ] ), 0.0 ) ;
+		else if ( states[ i ] == STATE_PENDING )
+			remaining = estimates[ i ] ;
+
+		double start = 0 ;
+		for ( unsigned int d = 0 ; d < dependencies[ i ] .size() ; d++ )
+			start = std::max( start, finish[ dependencies[ i ][ d ] ] ) ;
+		finish[ i ] = start + remaining ;
+		remaining_time = std::max( remaining_time, finish[ i ] ) ;
+	}
 
-		label_current .set_markup( "<b>" + operations[ t ] ->description + "</b>" ) ;
-		
-		progressbar_all .set_text( String::ucompose( _("%1 of %2 operations completed"), t, operations .size() ) ) ;
-		progressbar_all .set_fraction( fraction * t > 1.0 ? 1.0 : fraction * t ) ;
-		
-		treerow = treestore_operations ->children()[ t ] ;
+	return remaining_time ;
+}
 
-		//set status to 'execute'
-		operations[ t ] ->operation_detail .set_status( STATUS_EXECUTE ) ;
+//Show the updates queued by the operation thread.  Called with the GDK lock held.
+void Dialog_Progress::apply_progress_updates()
+{
+	std::vector<ProgressUpdate> updates ;
+	{
+		Glib::Mutex::Lock lock( progress_mutex ) ;
+		updates .swap( progress_updates ) ;
+		progress_update_indexes .clear() ;
+	}
 
-		//set focus...
-		treeview_operations .set_cursor( static_cast<Gtk::TreePath>( treerow ) ) ;
-		
-		//and start..
-		running = true ;
-		pthread_create( & pthread, NULL, Dialog_Progress::static_pthread_apply_operation, this );
+	if ( updates .empty() )
+		return ;
+
+	for ( unsigned int i = 0 ; i < updates .size() ; i++ )
+		update_row( updates[ i ] ) ;
+	update_gui_elements() ;
+}
+
+void Dialog_Progress::dispatcher_on_progress()
+{
+	//Test for queued updates before taking the GDK lock, so that a late wakeup
+	//  arriving in a main loop run while the lock is held is harmless
+	{
+		Glib::Mutex::Lock lock( progress_mutex ) ;
+		if ( progress_updates .empty() )
+			return ;
+	}
+
+	gdk_threads_enter() ;
+	apply_progress_updates() ;
+	gdk_threads_leave() ;
+}
+
+void Dialog_Progress::dispatcher_on_operation_done()
+{
+	main_loop ->quit() ;
+}
+
+bool Dialog_Progress::on_pulse_timeout()
+{
+	if ( ! pulse )
+		return false ;
+
+	gdk_threads_enter() ;
+	progressbar_current .pulse() ;
+	gdk_threads_leave() ;
+
+	return true ;
+}
+
+void Dialog_Progress::on_limits_changed()
+{
+	IOThrottle::set_limits( Byte_Value( spinbutton_bandwidth .get_value_as_int() ) * MEBIBYTE,
+	                        spinbutton_iops .get_value_as_int() ) ;
+}
+
+void Dialog_Progress::on_signal_show()
+{
+	//An operation waits for the earlier operations it conflicts with.  Others are
+	//  applied in parallel, by at most max_parallel_operations threads.
+	dependencies .assign( operations .size(), std::vector<unsigned int>() ) ;
+	std::vector<bool> more_operations( operations .size(), false ) ;
+	for ( unsigned int i = 0 ; i < operations .size() ; i++ )
+		for ( unsigned int j = i + 1 ; j < operations .size() ; j++ )
+			if ( operations_conflict( operations[ i ], operations[ j ] ) )
+			{
+				dependencies[ j ] .push_back( i ) ;
+				more_operations[ i ] = true ;
+			}
 
-		while ( running )
+	//Label, UUID and check operations queued one after the other on the same
+	//  partition are applied together by the thread of the first one
+	leaders .assign( operations .size(), 0 ) ;
+	groups .assign( operations .size(), std::vector<unsigned int>() ) ;
+	for ( unsigned int j = 0 ; j < operations .size() ; j++ )
+	{
+		leaders[ j ] = j ;
+		if ( ! dependencies[ j ] .empty() )
+		{
+			unsigned int leader = leaders[ dependencies[ j ] .back() ] ;
+			bool fusable = groups[ leader ] .back() == dependencies[ j ] .back() ;
+			for ( unsigned int g = 0 ; g < groups[ leader ] .size() && fusable ; g++ )
+				fusable = operations_fusable( operations[ groups[ leader ] [ g ] ], operations[ j ] ) ;
+			if ( fusable )
+				leaders[ j ] = leader ;
+		}
+		groups[ leaders[ j ] ] .push_back( j ) ;
+	}
+
+	Utils::set_operations_cancelled( false ) ;
+	states .assign( operations .size(), STATE_PENDING ) ;
+	operation_threads .resize( operations .size() ) ;
+	pthreads .resize( operations .size() ) ;
+	start_times .assign( operations .size(), 0 ) ;
+	for ( unsigned int i = 0 ; i < operations .size() ; i++ )
+		estimates .push_back( signal_estimate_duration .emit( operations[ i ] ) ) ;
+	timer_total .start() ;
+	unsigned int running = 0 ;
+	while ( true )
+	{
+		//as before, no further operations are started once one has failed
+		for ( unsigned int i = 0 ;
+		      i < operations .size() && succes && ! cancel && running < max_parallel_operations ;
+		      i++ )
 		{
-			if ( pulse )
-				progressbar_current .pulse() ;
-			
-			while ( Gtk::Main::events_pending() )
-				Gtk::Main::iteration();
-			gdk_threads_leave();
-			usleep( 100000 ) ;
-			gdk_threads_enter();
+			bool ready = states[ i ] == STATE_PENDING && leaders[ i ] == i ;
+			for ( unsigned int d = 0 ; d < dependencies[ i ] .size() && ready ; d++ )
+				ready = states[ dependencies[ i ][ d ] ] == STATE_DONE ;
+
+			if ( ready )
+			{
+				start_operation( i, more_operations[ groups[ i ] .back() ] ) ;
+				running++ ;
+			}
 		}
 
-		//set status (succes/error) for this operation
-		operations[ t ] ->operation_detail .set_status( succes ? STATUS_SUCCES : STATUS_ERROR ) ;
+		if ( running == 0 || cancel )
+			break ;
+
+		//show the progress of the first running operation
+		unsigned int first_running = 0 ;
+		while ( states[ first_running ] != STATE_RUNNING )
+			first_running++ ;
+		show_operation( first_running ) ;
+
+		Glib::ustring markup = "<b>" + operations[ shown_operation ] ->description + "</b>" ;
+		if ( running > 1 )
+			markup += "\n" + String::ucompose( ngettext( "and %1 more operation running",
+			                                              "and %1 more operations running",
+			                                              running - 1 ),
+			                                    running - 1 ) ;
+		label_current .set_markup( markup ) ;
+
+		update_progress_all() ;
+
+		//sleep in the main loop until an operation thread publishes progress or
+		//  finishes, or the user does something
+		gdk_threads_leave();
+		main_loop ->run() ;
+		gdk_threads_enter();
+
+		apply_progress_updates() ;
+
+		unsigned int previously_completed = completed ;
+		running -= collect_finished_operations() ;
+
+		//the finished operations added to the measurements the estimates are based on
+		if ( completed > previously_completed )
+			for ( unsigned int i = 0 ; i < operations .size() ; i++ )
+				if ( states[ i ] == STATE_PENDING )
+					estimates[ i ] = signal_estimate_duration .emit( operations[ i ] ) ;
 	}
+
+	//Wait for every operation thread, the cancelled ones too, so that none still
+	//  uses the disks when they are rescanned.  The GDK lock is released as a
+	//  thread may need it to ask about a libparted exception before it ends.
+	gdk_threads_leave() ;
+	for ( unsigned int i = 0 ; i < operations .size() ; i++ )
+		if ( states[ i ] != STATE_PENDING && leaders[ i ] == i )
+			pthread_join( pthreads[ i ], NULL ) ;
+	gdk_threads_enter() ;
+	Utils::set_operations_cancelled( false ) ;
+
+	//operations which finished before the cancel took effect
+	apply_progress_updates() ;
+	collect_finished_operations() ;
+
+	//Partition table changes held for operations which were to follow, when
+	//  applying was cancelled or stopped by an error, are written out now
+	std::vector<Operation *> applied_operations ;
+	for ( unsigned int i = 0 ; i < operations .size() ; i++ )
+		if ( states[ i ] != STATE_PENDING )
+			applied_operations .push_back( operations[ i ] ) ;
+	if ( ! signal_close_partition_tables .emit( applied_operations ) )
+		succes = false ;
+
+	pulse_connection .disconnect() ;
+
+	//operations still running were cancelled
+	for ( unsigned int i = 0 ; i < operations .size() ; i++ )
+		if ( states[ i ] == STATE_RUNNING )
+			operations[ i ] ->operation_detail .set_status( STATUS_ERROR ) ;
 	
 	//add save button
 	this ->add_button( _("_Save Details"), Gtk::RESPONSE_OK ) ; //there's no enum for SAVE
@@ -290,6 +561,133 @@ void Dialog_Progress::on_signal_show()
 	} 
 }
 
+//Set the status of the operations whose threads have finished since the last
+//  call, returning the number of threads which finished
+unsigned int Dialog_Progress::collect_finished_operations()
+{
+	std::vector< std::pair<unsigned int, OperationResult> > finished ;
+	{
+		Glib::Mutex::Lock lock( finished_mutex ) ;
+		finished .swap( finished_operations ) ;
+	}
+
+	unsigned int threads_finished = 0 ;
+	for ( unsigned int i = 0 ; i < finished .size() ; i++ )
+	{
+		//set status (succes/error/not run) for this operation
+		states[ finished[ i ] .first ] = STATE_DONE ;
+		OperationDetailStatus status = STATUS_N_A ;
+		if ( finished[ i ] .second == RESULT_SUCCES )
+			status = STATUS_SUCCES ;
+		else if ( finished[ i ] .second == RESULT_ERROR )
+			status = STATUS_ERROR ;
+		operations[ finished[ i ] .first ] ->operation_detail .set_status( status ) ;
+		succes = succes && finished[ i ] .second == RESULT_SUCCES ;
+		if ( leaders[ finished[ i ] .first ] == finished[ i ] .first )
+			threads_finished++ ;
+		completed++ ;
+	}
+
+	return threads_finished ;
+}
+
+//Start the thread applying the operation, together with the operations grouped
+//  with it
+void Dialog_Progress::start_operation( unsigned int index, bool more_operations )
+{
+	for ( unsigned int g = 0 ; g < groups[ index ] .size() ; g++ )
+	{
+		unsigned int member = groups[ index ][ g ] ;
+		operations[ member ] ->operation_detail .signal_update .connect(
+			sigc::mem_fun( this, &Dialog_Progress::on_signal_update ) ) ;
+
+		//set status to 'execute'
+		operations[ member ] ->operation_detail .set_status( STATUS_EXECUTE ) ;
+
+		states[ member ] = STATE_RUNNING ;
+		start_times[ member ] = timer_total .elapsed() ;
+	}
+
+	operation_threads[ index ] .dialog = this ;
+	operation_threads[ index ] .indexes = groups[ index ] ;
+	operation_threads[ index ] .more_operations = more_operations ;
+	pthread_create( & pthreads[ index ], NULL, Dialog_Progress::static_pthread_apply_operation,
+	                & operation_threads[ index ] ) ;
+}
+
+//Show the progress of this operation in the gui elements
+void Dialog_Progress::show_operation( unsigned int index )
+{
+	if ( index == shown_operation )
+		return ;
+
+	shown_operation = index ;
+	current_fraction = -1 ;
+	current_progress_text = "" ;
+	label_current_sub_text = operations[ index ] ->operation_detail .get_description() ;
+	pulse = true ;
+	update_gui_elements() ;
+
+	//set focus...
+	treerow = treestore_operations ->children()[ index ] ;
+	treeview_operations .set_cursor( static_cast<Gtk::TreePath>( treerow ) ) ;
+}
+
+//Operations conflict when they use a common disk, as overlapping partitions,
+//  partitions inside an extended partition and the partition table itself are all
+//  on the disk.  Operations on device-mapper and software RAID devices sit on top
+//  of other disks, so they conflict with all operations.
+bool Dialog_Progress::operations_conflict( const Operation * first, const Operation * second )
+{
+	std::vector<Glib::ustring> first_devices = get_operation_devices( first ) ;
+	std::vector<Glib::ustring> second_devices = get_operation_devices( second ) ;
+	for ( unsigned int i = 0 ; i < first_devices .size() ; i++ )
+		for ( unsigned int j = 0 ; j < second_devices .size() ; j++ )
+			if ( first_devices[ i ] == second_devices[ j ] ||
+			     first_devices[ i ] .empty() || second_devices[ j ] .empty() )
+				return true ;
+
+	return false ;
+}
+
+//Operations of a different kind which only write to the file system of the same
+//  partition can share one calibration, and the label and UUID one command
+bool Dialog_Progress::operations_fusable( const Operation * first, const Operation * second )
+{
+	if ( first ->type == second ->type )
+		return false ;
+
+	for ( unsigned int t = 0 ; t < 2 ; t++ )
+	{
+		OperationType type = t == 0 ? first ->type : second ->type ;
+		if ( type != OPERATION_LABEL_PARTITION &&
+		     type != OPERATION_CHANGE_UUID &&
+		     type != OPERATION_CHECK )
+			return false ;
+	}
+
+	return first ->partition_new .device_path == second ->partition_new .device_path &&
+	       first ->partition_new .sector_start == second ->partition_new .sector_start &&
+	       first ->partition_new .sector_end == second ->partition_new .sector_end ;
+}
+
+//The disks an operation uses, with an empty path for a stacked device
+std::vector<Glib::ustring> Dialog_Progress::get_operation_devices( const Operation * operation )
+{
+	std::vector<Glib::ustring> devices ;
+	devices .push_back( operation ->device .get_path() ) ;
+	if ( operation ->type == OPERATION_COPY )
+		devices .push_back( static_cast<const OperationCopy *>( operation ) ->partition_copied .device_path ) ;
+
+	for ( unsigned int t = 0 ; t < devices .size() ; t++ )
+		if ( devices[ t ] .substr( 0, 12 ) == "/dev/mapper/" ||
+		     devices[ t ] .substr( 0, 8 ) == "/dev/dm-" ||
+		     devices[ t ] .substr( 0, 7 ) == "/dev/md" )
+			devices[ t ] .clear() ;
+
+	return devices ;
+}
+
 void Dialog_Progress::on_expander_changed() 
 {
 	this ->set_resizable( expander_details .get_expanded() ) ;
@@ -301,13 +699,39 @@ void Dialog_Progress::on_cell_data_description( Gtk::CellRenderer * renderer, co
 		static_cast<Gtk::TreeRow>( *iter )[ treeview_operations_columns .operation_description ] ;
 }
 
-void * Dialog_Progress::static_pthread_apply_operation( void * p_dialog_progress ) 
+//A thread is only cancelled while it doesn't hold the operations lock, see
+//  Utils::lock_operations(), but it mustn't keep the lock in any case
+static void on_operation_thread_cancelled( void * )
 {
-	Dialog_Progress *dp = static_cast<Dialog_Progress *>( p_dialog_progress ) ;
+	Utils::release_operations_lock() ;
+}
+
+void * Dialog_Progress::static_pthread_apply_operation( void * p_operation_thread ) 
+{
+	OperationThread * operation_thread = static_cast<OperationThread *>( p_operation_thread ) ;
+	Dialog_Progress *dp = operation_thread ->dialog ;
 	
-	dp ->succes = dp ->signal_apply_operation .emit( dp ->operations[ dp ->t ] ) ;
+	//Let the core know whether more operations follow on the disks, so partition
+	//  table changes can be held back until they are needed
+	std::vector<Operation *> operations ;
+	for ( unsigned int t = 0 ; t < operation_thread ->indexes .size() ; t++ )
+		operations .push_back( dp ->operations[ operation_thread ->indexes[ t ] ] ) ;
+
+	std::vector<OperationResult> results ;
+	pthread_cleanup_push( on_operation_thread_cancelled, NULL ) ;
+	dp ->signal_apply_operations .emit( operations, results, operation_thread ->more_operations ) ;
+	pthread_cleanup_pop( 0 ) ;
+
+	//the operations are over, so their results must be reported
+	pthread_setcancelstate( PTHREAD_CANCEL_DISABLE, NULL ) ;
 	
-	dp ->running = false ;
+	{
+		Glib::Mutex::Lock lock( dp ->finished_mutex ) ;
+		for ( unsigned int t = 0 ; t < operation_thread ->indexes .size() ; t++ )
+			dp ->finished_operations .push_back( std::make_pair( operation_thread ->indexes[ t ],
+			                                                     t < results .size() ? results[ t ] : RESULT_ERROR ) ) ;
+	}
+	dp ->dispatcher_operation_done() ;
 
 	return NULL ;
 }
@@ -328,10 +752,15 @@ void Dialog_Progress::on_cancel()
 	
 	if ( dialog .run() == Gtk::RESPONSE_CANCEL )
 	{
-		pthread_cancel( pthread ) ;
+		//No operation starts another step from now on.  Those waiting for a
+		//  command or copying blocks are stopped, the others end their step first.
+		Utils::set_operations_cancelled( true ) ;
+		for ( unsigned int t = 0 ; t < states .size() ; t++ )
+			if ( states[ t ] == STATE_RUNNING && leaders[ t ] == t )
+				pthread_cancel( pthreads[ t ] ) ;
 		cancel = true ;
-		running = false ;
 		succes = false ;
+		main_loop ->quit() ;
 	}
 }
 
@@ -390,8 +819,23 @@ void Dialog_Progress::echo_operation_details( const OperationDetail & operationd
 	//and export everything to some kind of html...
 	out << "<table border='0'>" << std::endl
 	<< "<tr>" << std::endl
-	<< "<td colspan='2'>" << std::endl
-	<< temp ;
+	<< "<td colspan='2'>" << std::endl ;
+
+	//large command output only keeps its start and end in memory, the complete
+	//  text is copied from its log file one line at a time
+	std::ifstream log_file ;
+	if ( ! operationdetail .get_log_file() .empty() )
+		log_file .open( operationdetail .get_log_file() .c_str() ) ;
+	if ( log_file .is_open() )
+	{
+		out << "<i>" ;
+		std::string line ;
+		for ( bool first = true ; std::getline( log_file, line ) ; first = false )
+			out << ( first ? "" : "<br />" ) << Glib::Markup::escape_text( line ) ;
+		out << "</i>" ;
+	}
+	else
+		out << temp ;
 	if ( ! operationdetail .get_elapsed_time() .empty() )
 		out << "&nbsp;&nbsp;" << operationdetail .get_elapsed_time() ;
 	
@@ -458,7 +902,7 @@ void Dialog_Progress::echo_operation_details( const OperationDetail & operationd
 		<< "<td>" << std::endl ;
 
 		for ( unsigned int t = 0 ; t <  operationdetail .get_childs() .size() ; t++ )
-			echo_operation_details( operationdetail .get_childs()[ t ], out ) ;
+			echo_operation_details( *operationdetail .get_childs()[ t ], out ) ;
 
 		out << "</td>" << std::endl << "</tr>" << std::endl ;
 	}
@@ -487,6 +931,11 @@ bool Dialog_Progress::on_delete_event( GdkEventAny * event )
 }
 
 
+void Dialog_Progress::set_max_parallel_operations( unsigned int max_operations )
+{
+	max_parallel_operations = max_operations > 0 ? max_operations : 1 ;
+}
+
 Dialog_Progress::~Dialog_Progress()
 {
 }
@@ -29,6 +29,8 @@ namespace GParted
 DrawingAreaVisualDisk::DrawingAreaVisualDisk()
 {
 	selected_vp = NULL ;
+	layout_width = -1 ;
+	layout_device_length = -1 ;
 
 	//set and allocated some standard colors
 	color_used .set( Utils::get_color( GParted::FS_USED ) );
@@ -50,10 +52,20 @@ DrawingAreaVisualDisk::DrawingAreaVisualDisk()
 	
 void DrawingAreaVisualDisk::load_partitions( const std::vector<Partition> & partitions, Sector device_length )
 {
+	//keep the layout, colors and offscreen drawing when the partitions would be
+	//  drawn the same, only forgetting the selection
+	if ( device_length == layout_device_length && update_static_data( partitions, visual_partitions ) )
+	{
+		selected_vp = NULL ;
+		queue_draw() ;
+		return ;
+	}
+
 	clear() ;	
 	
 	TOT_SEP = get_total_separator_px( partitions ) ;
 	set_static_data( partitions, visual_partitions, device_length ) ;
+	layout_device_length = device_length ;
 
 	queue_resize() ;
 }
@@ -71,6 +83,9 @@ void DrawingAreaVisualDisk::clear()
 	free_colors( visual_partitions ) ;
 	visual_partitions .clear() ;
 	selected_vp = NULL ;
+	layout_width = -1 ;
+	layout_device_length = -1 ;
+	pixmap .clear() ;
 	
 	queue_resize() ;
 }
@@ -103,12 +118,38 @@ void DrawingAreaVisualDisk::set_static_data( const std::vector<Partition> & part
 		if ( ! partitions[ t ] .logicals .empty() )
 			set_static_data( partitions[ t ] .logicals,
 					 visual_partitions .back() .logicals, partition_length ) ;
-		else
-			visual_partitions .back() .pango_layout = create_pango_layout( 
-				partitions[ t ] .get_path() + "\n" + Utils::format_size( partition_length, partitions[ t ] .sector_size ) ) ;
 	}
 }
 
+//Replace the partitions shown by the visual partitions with the given ones, as long
+//  as they are drawn the same.  Returns false at the first one which isn't.
+bool DrawingAreaVisualDisk::update_static_data( const std::vector<Partition> & partitions,
+						std::vector<visual_partition> & visual_partitions )
+{
+	if ( partitions .size() != visual_partitions .size() )
+		return false ;
+
+	for ( unsigned int t = 0 ; t < partitions .size() ; t++ )
+	{
+		const Partition & partition = visual_partitions[ t ] .partition ;
+		if (    partition != partitions[ t ]
+		     || partition .sector_end          != partitions[ t ] .sector_end
+		     || partition .sector_size         != partitions[ t ] .sector_size
+		     || partition .sectors_used        != partitions[ t ] .sectors_used
+		     || partition .sectors_unused      != partitions[ t ] .sectors_unused
+		     || partition .sectors_unallocated != partitions[ t ] .sectors_unallocated
+		     || partition .filesystem          != partitions[ t ] .filesystem
+		     || partition .get_path()          != partitions[ t ] .get_path()
+		     || ! update_static_data( partitions[ t ] .logicals, visual_partitions[ t ] .logicals )
+		   )
+			return false ;
+
+		visual_partitions[ t ] .partition = partitions[ t ] ;
+	}
+
+	return true ;
+}
+
 int DrawingAreaVisualDisk::calc_length( std::vector<visual_partition> & visual_partitions, int length_px ) 
 {
 	int calced_length = 0 ;
@@ -199,6 +240,17 @@ void DrawingAreaVisualDisk::calc_text( std::vector<visual_partition> & visual_pa
 	
 	for ( unsigned int t = 0 ; t < visual_partitions .size() ; t++ )
 	{
+		//the text layout is only created once a partition is wide enough to show it
+		if (    visual_partitions[ t ] .logicals .empty()
+		     && ! visual_partitions[ t ] .pango_layout
+		     && visual_partitions[ t ] .length - (2 * BORDER) - 2 > 0 )
+		{
+			const Partition & partition = visual_partitions[ t ] .partition ;
+			visual_partitions[ t ] .pango_layout = create_pango_layout(
+				partition .get_path() + "\n" +
+				Utils::format_size( partition .get_sector_length(), partition .sector_size ) ) ;
+		}
+
 		if ( visual_partitions[ t ] .pango_layout )
 		{
 			//see if the text fits in the partition... (and if so, center the text..)
@@ -220,72 +272,77 @@ void DrawingAreaVisualDisk::calc_text( std::vector<visual_partition> & visual_pa
 	}
 }
 
-void DrawingAreaVisualDisk::draw_partition( const visual_partition & vp ) 
+void DrawingAreaVisualDisk::draw_partition( const Glib::RefPtr<Gdk::Drawable> & drawable, const visual_partition & vp ) 
 {
+	//partitions narrower than a pixel would only overdraw their neighbours
+	if ( vp .length <= 0 )
+		return ;
+
 	//partition...
 	gc ->set_foreground( vp .color );
-	get_window() ->draw_rectangle( gc, 
-			 	       true,
-				       vp .x_start,
-				       vp .y_start,
-				       vp .length,
-				       vp .height );
+	drawable ->draw_rectangle( gc, 
+				   true,
+				   vp .x_start,
+				   vp .y_start,
+				   vp .length,
+				   vp .height );
 			
 	//used..
 	if ( vp .used_length > 0 )
 	{
 		gc ->set_foreground( color_used );
-		get_window() ->draw_rectangle( gc,
-					       true,
-					       vp .x_used_start, 
-					       vp .y_usage_start,
-					       vp .used_length,
-					       vp .usage_height );
+		drawable ->draw_rectangle( gc,
+					   true,
+					   vp .x_used_start, 
+					   vp .y_usage_start,
+					   vp .used_length,
+					   vp .usage_height );
 	}
 		
 	//unused
 	if ( vp .unused_length > 0 )
 	{
 		gc ->set_foreground( color_unused );
-		get_window() ->draw_rectangle( gc,
-					       true,
-					       vp .x_unused_start, 
-					       vp .y_usage_start,
-					       vp .unused_length,
-					       vp .usage_height );
+		drawable ->draw_rectangle( gc,
+					   true,
+					   vp .x_unused_start, 
+					   vp .y_usage_start,
+					   vp .unused_length,
+					   vp .usage_height );
 	}
 
 	//unallocated
 	if ( vp .unallocated_length > 0 )
 	{
 		gc ->set_foreground( color_unallocated );
-		get_window() ->draw_rectangle( gc,
-					       true,
-					       vp .x_unallocated_start,
-					       vp .y_usage_start,
-					       vp .unallocated_length,
-					       vp .usage_height );
+		drawable ->draw_rectangle( gc,
+					   true,
+					   vp .x_unallocated_start,
+					   vp .y_usage_start,
+					   vp .unallocated_length,
+					   vp .usage_height );
 	}
 
 	//text
 	if ( vp .x_text > 0 )
 	{
 		gc ->set_foreground( color_text );
-		get_window() ->draw_layout( gc,
-					    vp .x_text,
-					    vp .y_text,
-					    vp .pango_layout ) ;
+		drawable ->draw_layout( gc,
+					vp .x_text,
+					vp .y_text,
+					vp .pango_layout ) ;
 	}
 }
 
-void DrawingAreaVisualDisk::draw_partitions( const std::vector<visual_partition> & visual_partitions ) 
+void DrawingAreaVisualDisk::draw_partitions( const Glib::RefPtr<Gdk::Drawable> & drawable,
+					     const std::vector<visual_partition> & visual_partitions ) 
 {
 	for ( unsigned int t = 0 ; t < visual_partitions .size() ; t++ )
 	{
-		draw_partition( visual_partitions[ t ] ) ;
+		draw_partition( drawable, visual_partitions[ t ] ) ;
 
 		if ( visual_partitions[ t ] .logicals .size() > 0 )
-			draw_partitions( visual_partitions[ t ] .logicals ) ;
+			draw_partitions( drawable, visual_partitions[ t ] .logicals ) ;
 	}
 }
 
@@ -335,7 +392,27 @@ bool DrawingAreaVisualDisk::on_expose_event( GdkEventExpose * event )
 {
 	bool ret_val = Gtk::DrawingArea::on_expose_event( event ) ;
 	
-	draw_partitions( visual_partitions ) ;
+	//the partitions are drawn once per layout into an offscreen pixmap, from
+	//  which exposed areas are copied
+	if ( ! pixmap )
+	{
+		int width = get_allocation() .get_width() ;
+		int height = get_allocation() .get_height() ;
+		pixmap = Gdk::Pixmap::create( get_window(), width, height ) ;
+
+		gc ->set_foreground( get_style() ->get_bg( Gtk::STATE_NORMAL ) ) ;
+		pixmap ->draw_rectangle( gc, true, 0, 0, width, height ) ;
+		draw_partitions( pixmap, visual_partitions ) ;
+	}
+
+	get_window() ->draw_drawable( gc,
+				      pixmap,
+				      event ->area .x,
+				      event ->area .y,
+				      event ->area .x,
+				      event ->area .y,
+				      event ->area .width,
+				      event ->area .height ) ;
 	 
 	//selection 
 	if ( selected_vp )
@@ -376,6 +453,13 @@ bool DrawingAreaVisualDisk::on_button_press_event( GdkEventButton * event )
 void DrawingAreaVisualDisk::on_size_allocate( Gtk::Allocation & allocation ) 
 {
 	Gtk::DrawingArea::on_size_allocate( allocation ) ;
+	pixmap .clear() ;
+
+	//the layout only depends on the partitions and the width, so keep it while
+	//  neither has changed
+	if ( allocation .get_width() == layout_width )
+		return ;
+	layout_width = allocation .get_width() ;
 
 	MIN_SIZE = BORDER * 2 + 2 ;
 
@@ -21,34 +21,27 @@ namespace GParted
 {
 
 //initialize static data elements
+Glib::Mutex FS_Info::mutex ;
 bool FS_Info::fs_info_cache_initialized = false ;
 bool FS_Info::blkid_found  = false ;
 bool FS_Info::vol_id_found  = false ;
 Glib::ustring FS_Info::fs_info_cache = "";
 
+//The cache may be used by several threads at once.  The mutex guards the cache,
+//  but is never held while a command runs.  The commands found are only set
+//  when the first object is constructed.
+
 FS_Info::FS_Info()
 {
 	//Ensure that cache has been loaded at least once
-	if ( ! fs_info_cache_initialized )
-	{
-		fs_info_cache_initialized = true ;
-		set_commands_found() ;
+	if ( set_commands_found() )
 		load_fs_info_cache() ;
-	}
 }
 
 FS_Info:: FS_Info( bool do_refresh )
 {
 	//Ensure that cache has been loaded at least once
-	if ( ! fs_info_cache_initialized )
-	{
-		fs_info_cache_initialized = true ;
-		set_commands_found() ;
-		if ( do_refresh == false )
-			load_fs_info_cache() ;
-	}
-
-	if ( do_refresh )
+	if ( set_commands_found() || do_refresh )
 		load_fs_info_cache() ;
 }
 
@@ -61,24 +54,32 @@ void FS_Info::load_fs_info_cache()
 	Glib::ustring output, error ;
 	if ( blkid_found )
 	{
-		if ( ! Utils::execute_command( "blkid", output, error, true ) )
-			fs_info_cache = output ;
-		else
-			fs_info_cache = "" ;
+		if ( Utils::execute_command( "blkid", output, error, true ) )
+			output = "" ;
+
+		Glib::Mutex::Lock lock( mutex ) ;
+		fs_info_cache = output ;
 	}
 }
 
-void FS_Info::set_commands_found()
+//Set status of commands found, the first time only.  Returns whether it did.
+bool FS_Info::set_commands_found()
 {
-	//Set status of commands found 
+	Glib::Mutex::Lock lock( mutex ) ;
+	if ( fs_info_cache_initialized )
+		return false ;
+
+	fs_info_cache_initialized = true ;
 	blkid_found = (! Glib::find_program_in_path( "blkid" ) .empty() ) ;
 	vol_id_found = (! Glib::find_program_in_path( "vol_id" ) .empty() ) ;
+	return true ;
 }
 
 Glib::ustring FS_Info::get_device_entry( const Glib::ustring & path )
 {
 	//Retrieve the line containing the device path
 	Glib::ustring regexp = "^" + path + ":([^\n]*)$" ;
+	Glib::Mutex::Lock lock( mutex ) ;
 	Glib::ustring entry = Utils::regexp_label( fs_info_cache, regexp ) ;
 	return entry;
 }
@@ -157,6 +158,7 @@ Glib::ustring FS_Info::get_path_by_uuid( const Glib::ustring & uuid )
 {
 	//Retrieve the path given the uuid
 	Glib::ustring regexp = "^([^:]*):.*UUID=\"" + uuid + "\".*$" ;
+	Glib::Mutex::Lock lock( mutex ) ;
 	Glib::ustring path = Utils::regexp_label( fs_info_cache, regexp ) ;
 
 	return path ;
@@ -166,6 +168,7 @@ Glib::ustring FS_Info::get_path_by_label( const Glib::ustring & label )
 {
 	//Retrieve the path given the label
 	Glib::ustring regexp = "^([^:]*):.*LABEL=\"" + label + "\".*$" ;
+	Glib::Mutex::Lock lock( mutex ) ;
 	Glib::ustring path = Utils::regexp_label( fs_info_cache, regexp ) ;
 
 	return path ;
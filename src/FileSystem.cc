@@ -17,12 +17,16 @@
  
  
 #include "../include/FileSystem.h"
+#include "../include/CoreSession.h"
+#include "../include/IOThrottle.h"
 
 #include <cerrno>
+#include <cmath>
+#include <cctype>
 
 namespace GParted
 {
-	
+
 FileSystem::FileSystem()
 {
 }
@@ -48,21 +52,165 @@ const Glib::ustring FileSystem::get_generic_text( CUSTOM_TEXT ttype, int index )
 	}
 }
 
-int FileSystem::execute_command( const Glib::ustring & command, OperationDetail & operationdetail ) 
+//Write the label and a new UUID.  File systems whose tool does both in one run
+//  override this.
+bool FileSystem::write_label_and_uuid( const Partition & partition, OperationDetail & operationdetail )
+{
+	return write_label( partition, operationdetail ) && write_uuid( partition, operationdetail ) ;
+}
+
+//Run command and add the results to operation detail.  With a progress parser the
+//  output is read while the command runs and the progress it prints is shown.
+int FileSystem::execute_command( const Glib::ustring & command,
+                                 OperationDetail & operationdetail,
+                                 ProgressParser progress_parser )
 {
 	operationdetail .add_child( OperationDetail( command, STATUS_NONE, FONT_BOLD_ITALIC ) ) ;
 
-	int exit_status = Utils::execute_command( "nice -n 19 " + command, output, error ) ;
+	int exit_status ;
+	if ( progress_parser )
+	{
+		//other operations may use this object while the command runs, so the
+		//  progress state is kept here
+		CommandProgress progress ;
+		progress .parser = progress_parser ;
+		progress .operationdetail = &operationdetail .get_last_child() ;
+		progress .fraction = -1 ;
+		progress .timer .start() ;
+		exit_status = Utils::execute_command_streamed(
+				IOThrottle::get_command_prefix() + "nice -n 19 " + command,
+				output,
+				error,
+				sigc::bind( sigc::ptr_fun( &FileSystem::on_command_output ), &progress ) ) ;
+
+		//make room for a new progress bar (or a pulsebar)
+		operationdetail .get_last_child() .set_progress( -1, "" ) ;
+	}
+	else
+		exit_status = Utils::execute_command( IOThrottle::get_command_prefix() + "nice -n 19 " + command, output, error ) ;
 
 	if ( ! output .empty() )
-		operationdetail .get_last_child() .add_child( OperationDetail( output, STATUS_NONE, FONT_ITALIC ) ) ;
+		operationdetail .get_last_child() .add_child_output( output ) ;
 	
 	if ( ! error .empty() )
-		operationdetail .get_last_child() .add_child( OperationDetail( error, STATUS_NONE, FONT_ITALIC ) ) ;
+		operationdetail .get_last_child() .add_child_output( error ) ;
 
 	return exit_status ;
 }
 
+//Run a read only command which inspects a file system, storing the results in
+//  output and error.  Results are cached in the session, so the usage, label and
+//  UUID reading methods share a single run of the same command on a partition
+//  while a device is scanned.
+int FileSystem::execute_probe_command( const Glib::ustring & command, bool use_C_locale )
+{
+	std::map< Glib::ustring, CoreSession::ProbeResult > & probe_results = CoreSession::get() .probe_results ;
+	Glib::ustring key = ( use_C_locale ? "C " : "- " ) + command ;
+	std::map< Glib::ustring, CoreSession::ProbeResult >::iterator iter = probe_results .find( key ) ;
+	if ( iter == probe_results .end() )
+	{
+		CoreSession::ProbeResult result ;
+		result .exit_status = Utils::execute_command( command, result .output, result .error, use_C_locale ) ;
+		iter = probe_results .insert( std::make_pair( key, result ) ) .first ;
+	}
+
+	output = iter ->second .output ;
+	error = iter ->second .error ;
+	return iter ->second .exit_status ;
+}
+
+//Show the progress found in a line of output of a running command
+void FileSystem::on_command_output( const std::string & line, CommandProgress * progress )
+{
+	double fraction ;
+	if ( ! progress ->parser( line, fraction ) || fraction < 0 || fraction > 1 )
+		return ;
+
+	//tools redraw their progress far more often than it changes
+	if ( progress ->fraction >= 0 && std::fabs( fraction - progress ->fraction ) < 0.001 )
+		return ;
+
+	//a tool with several passes restarts from zero, so does the estimate
+	if ( fraction < progress ->fraction )
+		progress ->timer .start() ;
+	progress ->fraction = fraction ;
+
+	Glib::ustring progress_text ;
+	if ( fraction >= 0.01 )
+	{
+		std::time_t time_remaining = Utils::round( progress ->timer .elapsed() * ( 1 - fraction ) / fraction ) ;
+		/*TO TRANSLATORS: looks like  45% complete (00:01:59 remaining) */
+		progress_text = String::ucompose( _("%1%% complete (%2 remaining)"),
+		                                  Utils::round( fraction * 100 ),
+		                                  Utils::format_time( time_remaining ) ) ;
+	}
+	else
+		/*TO TRANSLATORS: looks like  0% complete */
+		progress_text = String::ucompose( _("%1%% complete"), Utils::round( fraction * 100 ) ) ;
+
+	progress ->operationdetail ->set_progress( fraction, progress_text ) ;
+}
+
+//Read the last percentage printed on a line, like the progress of e2fsck -C 0
+//  ("/dev/sdb1: |=====      |  45.2%") or ntfsresize and ntfsclone
+//  ("45.23 percent completed").  A percentage followed by more text, such as the
+//  "(0.1%)" in file system statistics, isn't progress.
+bool FileSystem::parse_percent_progress( const std::string & line, double & fraction )
+{
+	std::string::size_type end = line .rfind( '%' ) ;
+	if ( end != std::string::npos )
+	{
+		if ( line .find_first_not_of( " \t|/-\\", end + 1 ) != std::string::npos )
+			return false ;
+	}
+	else
+	{
+		end = line .rfind( " percent completed" ) ;
+		if ( end == std::string::npos )
+			return false ;
+	}
+
+	//parse the number by hand as tools print a '.' whatever the locale
+	std::string::size_type start = end ;
+	while ( start > 0 && ( isdigit( line[ start - 1 ] ) || line[ start - 1 ] == '.' ) )
+		start -- ;
+	if ( start == end )
+		return false ;
+
+	double percent = 0, scale = 0 ;
+	for ( std::string::size_type i = start ; i < end ; i ++ )
+	{
+		if ( line[ i ] == '.' )
+			scale = 1 ;
+		else
+		{
+			percent = percent * 10 + ( line[ i ] - '0' ) ;
+			scale *= 10 ;
+		}
+	}
+	if ( scale > 0 )
+		percent /= scale ;
+
+	fraction = percent / 100 ;
+	return true ;
+}
+
+//Read the progress bar of resize2fs -p, which prints 40 X's for each pass
+//  ("Relocating blocks             XXXXXXXXXXXXXXXX")
+bool FileSystem::parse_resize2fs_progress( const std::string & line, double & fraction )
+{
+	std::string::size_type end = line .find_last_not_of( ' ' ) ;
+	if ( end == std::string::npos || line[ end ] != 'X' )
+		return false ;
+
+	std::string::size_type start = line .find_last_not_of( 'X', end ) ;
+	if ( start == std::string::npos || line[ start ] != ' ' )
+		return false ;
+
+	fraction = ( end - start ) / 40.0 ;
+	return true ;
+}
+
 //Time command, add results to operation detail and by default set success or failure
 int FileSystem::execute_command_timed( const Glib::ustring & command
                                      , OperationDetail & operationdetail
@@ -70,7 +218,7 @@ int FileSystem::execute_command_timed( const Glib::ustring & command
 {
 	operationdetail .add_child( OperationDetail( command, STATUS_EXECUTE, FONT_BOLD_ITALIC ) ) ;
 
-	int exit_status = Utils::execute_command( "nice -n 19 " + command, output, error ) ;
+	int exit_status = Utils::execute_command( IOThrottle::get_command_prefix() + "nice -n 19 " + command, output, error ) ;
 	if ( check_status )
 	{
 		if ( ! exit_status )
@@ -80,10 +228,10 @@ int FileSystem::execute_command_timed( const Glib::ustring & command
 	}
 
 	if ( ! output .empty() )
-		operationdetail .get_last_child() .add_child( OperationDetail( output, STATUS_NONE, FONT_ITALIC ) ) ;
+		operationdetail .get_last_child() .add_child_output( output ) ;
 
 	if ( ! error .empty() )
-		operationdetail .get_last_child() .add_child( OperationDetail( error, STATUS_NONE, FONT_ITALIC ) ) ;
+		operationdetail .get_last_child() .add_child_output( error ) ;
 
 	return exit_status ;
 }
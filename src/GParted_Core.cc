@@ -22,6 +22,7 @@
 #include "../include/SWRaid.h"
 #include "../include/FS_Info.h"
 #include "../include/LVM2_PV_Info.h"
+#include "../include/Mount_Info.h"
 #include "../include/OperationCopy.h"
 #include "../include/OperationCreate.h"
 #include "../include/OperationDelete.h"
@@ -30,6 +31,10 @@
 #include "../include/OperationChangeUUID.h"
 #include "../include/OperationLabelPartition.h"
 #include "../include/Proc_Partitions_Info.h"
+#include "../include/DeviceFilter.h"
+#include "../include/IOThrottle.h"
+#include "../include/ThroughputModel.h"
+#include "../include/CoreSession.h"
 
 #include "../include/btrfs.h"
 #include "../include/exfat.h"
@@ -51,31 +56,41 @@
 #include "../include/reiser4.h"
 #include "../include/ufs.h"
 #include <set>
+#include <algorithm>
 #include <cerrno>
+#include <cstdlib>
 #include <cstring>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <dirent.h>
-#include <mntent.h>
 #include <gtkmm/messagedialog.h>
 
-std::vector<Glib::ustring> libparted_messages ; //see ped_exception_handler()
+//The libparted messages collected in the session of the calling thread, see
+//  ped_exception_handler().  Scans and operations in parallel each collect their own.
+static std::vector<Glib::ustring> & get_libparted_messages()
+{
+	return GParted::CoreSession::get() .libparted_messages ;
+}
 
 namespace GParted
 {
 
 std::vector<FS> GParted_Core::FILESYSTEMS ;
-std::map< FILESYSTEM, FileSystem * > GParted_Core::FILESYSTEM_MAP ;
 std::vector<PedPartitionFlag> GParted_Core::flags;
-std::map< Glib::ustring, std::vector<Glib::ustring> > GParted_Core::mount_info ;
-std::map< Glib::ustring, std::vector<Glib::ustring> > GParted_Core::fstab_info ;
-std::map< Glib::ustring, std::vector<Glib::ustring> >::iterator GParted_Core::iter_mp ;
+Glib::Mutex GParted_Core::thread_status_message_mutex ;
+Glib::RecMutex GParted_Core::scan_mutex ;
 Glib::ustring GParted_Core::thread_status_message ;
+Glib::ustring GParted_Core::programs_key ;
+std::map< Glib::ustring, GParted_Core::TableSession > GParted_Core::table_sessions ;
+std::map< Glib::ustring, unsigned long > GParted_Core::clean_checks ;
+std::map< Glib::ustring, unsigned long > GParted_Core::write_generations ;
+unsigned long GParted_Core::last_write_generation = 0 ;
 
 GParted_Core::GParted_Core() 
 {
-	thread_status_message = "" ;
+	set_thread_status_message( "" ) ;
 
 	ped_exception_set_handler( ped_exception_handler ) ; 
 
@@ -94,52 +109,68 @@ GParted_Core::GParted_Core()
 	find_supported_filesystems() ;
 }
 
+//Runs in the main thread while no scan or operation is running, as get_fs() hands
+//  out references into FILESYSTEMS
 void GParted_Core::find_supported_filesystems()
 {
-	std::map< FILESYSTEM, FileSystem * >::iterator f ;
-
-	// TODO: determine whether it is safe to initialize this only once
-	for ( f = FILESYSTEM_MAP .begin() ; f != FILESYSTEM_MAP .end() ; f++ ) {
-		if ( f ->second )
-			delete f ->second ;
-	}
-
-	FILESYSTEM_MAP .clear() ;
-
-	FILESYSTEM_MAP[ FS_BTRFS ]	= new btrfs() ;
-	FILESYSTEM_MAP[ FS_EXFAT ]	= new exfat() ;
-	FILESYSTEM_MAP[ FS_EXT2 ]	= new ext2() ;
-	FILESYSTEM_MAP[ FS_EXT3 ]	= new ext3() ;
-	FILESYSTEM_MAP[ FS_EXT4 ]	= new ext4() ;
-	FILESYSTEM_MAP[ FS_FAT16 ]	= new fat16() ;
-	FILESYSTEM_MAP[ FS_FAT32 ]	= new fat32() ;
-	FILESYSTEM_MAP[ FS_HFS ]	= new hfs() ;
-	FILESYSTEM_MAP[ FS_HFSPLUS ]	= new hfsplus() ;
-	FILESYSTEM_MAP[ FS_JFS ]	= new jfs() ;
-	FILESYSTEM_MAP[ FS_LINUX_SWAP ]	= new linux_swap() ;
-	FILESYSTEM_MAP[ FS_LVM2_PV ]	= new lvm2_pv() ;
-	FILESYSTEM_MAP[ FS_NILFS2 ]	= new nilfs2() ;
-	FILESYSTEM_MAP[ FS_NTFS ]	= new ntfs() ;
-	FILESYSTEM_MAP[ FS_REISER4 ]	= new reiser4() ;
-	FILESYSTEM_MAP[ FS_REISERFS ]	= new reiserfs() ;
-	FILESYSTEM_MAP[ FS_UFS ]	= new ufs() ;
-	FILESYSTEM_MAP[ FS_XFS ]	= new xfs() ;
-	FILESYSTEM_MAP[ FS_LUKS ]	= new luks() ;
-	FILESYSTEM_MAP[ FS_UNKNOWN ]	= NULL ;
+	//Probing every file system for its programs means hundreds of $PATH lookups
+	//  and running some of the programs, so keep the results until a directory
+	//  in $PATH changes
+	Glib::ustring key = get_programs_key() ;
+	if ( ! FILESYSTEMS .empty() && key == programs_key )
+		return ;
+	programs_key = key ;
 
 	FILESYSTEMS .clear() ;
 
-	FS fs_notsupp;
-	for ( f = FILESYSTEM_MAP .begin() ; f != FILESYSTEM_MAP .end() ; f++ ) {
-		if ( f ->second )
-			FILESYSTEMS .push_back( f ->second ->get_filesystem_support() ) ;
-		else {
-			fs_notsupp .filesystem = f ->first ;
+	//Only the file system types are needed here, not the objects used to
+	//  work on the file systems, which each session creates for itself
+	for ( int f = FS_UNALLOCATED ; f <= FS_LUKS ; f++ )
+	{
+		FILESYSTEM filesystem = static_cast<FILESYSTEM>( f ) ;
+		FileSystem * p_filesystem = new_filesystem_object( filesystem ) ;
+		if ( p_filesystem )
+		{
+			FILESYSTEMS .push_back( p_filesystem ->get_filesystem_support() ) ;
+			delete p_filesystem ;
+		}
+		else if ( filesystem == FS_UNKNOWN )
+		{
+			FS fs_notsupp ;
+			fs_notsupp .filesystem = filesystem ;
 			FILESYSTEMS .push_back( fs_notsupp ) ;
 		}
 	}
 }
 
+//Return a key which changes whenever programs are added to, removed from or
+//  replaced in a directory in $PATH, or the kernel's file system support changes
+Glib::ustring GParted_Core::get_programs_key()
+{
+	Glib::ustring path = Glib::getenv( "PATH" ) ;
+	Glib::ustring key = path ;
+
+	std::vector<Glib::ustring> dirs ;
+	Utils::split( path, dirs, ":" ) ;
+	for ( unsigned int t = 0 ; t < dirs .size() ; t++ )
+	{
+		struct stat st ;
+		if ( ! dirs[ t ] .empty() && stat( dirs[ t ] .c_str(), & st ) == 0 )
+			key += " " + Utils::num_to_str( st .st_mtime ) ;
+		else
+			key += " -" ;
+	}
+
+	//Some file systems also depend on kernel support, which can change when
+	//  modules are loaded
+	std::ifstream proc_filesystems( "/proc/filesystems" ) ;
+	std::string line ;
+	while ( getline( proc_filesystems, line ) )
+		key += " " + line ;
+
+	return key ;
+}
+
 void GParted_Core::set_user_devices( const std::vector<Glib::ustring> & user_devices ) 
 {
 	this ->device_paths = user_devices ;
@@ -152,10 +183,26 @@ bool GParted_Core::parse_device( const Glib::ustring& device_path, Device& temp_
 	return parse_device( device_path, pp_info, temp_device );
 }
 
-bool GParted_Core::parse_device( const Glib::ustring& device_path, Proc_Partitions_Info& pp_info, Device& temp_device )
+//Read device_path into temp_device.  Without read_details only the partition table
+//  and the file system types are read, leaving out the labels, UUIDs and usage
+//  which need external programs.
+bool GParted_Core::parse_device( const Glib::ustring& device_path,
+                                 Proc_Partitions_Info& pp_info,
+                                 Device& temp_device,
+                                 bool read_details )
 {
+	//Devices are scanned by the refresh, the selected device and the prefetch
+	//  threads, but libparted and the shared caches may only be used by one
+	Glib::RecMutex::Lock scan_lock( scan_mutex ) ;
+
+	//Results of file system probing commands are only shared while scanning one
+	//  device, and devices may be scanned in parallel
+	CoreSession session ;
+	std::vector<Glib::ustring> & libparted_messages = session .libparted_messages ;
+
 	/*TO TRANSLATORS: looks like Searching /dev/sda partitions */
 	set_thread_status_message( String::ucompose ( _("Searching %1 partitions"), device_path ) ) ;
+
 	PedDevice* lp_device = NULL;
 	PedDisk* lp_disk = NULL;
 	if ( !open_device_and_disk( device_path, lp_device, lp_disk, false ) )
@@ -166,6 +213,7 @@ bool GParted_Core::parse_device( const Glib::ustring& device_path, Proc_Partitio
 	//device info..
 	temp_device .add_path( device_path ) ;
 	temp_device .add_paths( pp_info .get_alternate_paths( temp_device .get_path() ) ) ;
+	temp_device .add_member_paths( pp_info .get_multipath_members( device_path ) ) ;
 
 	temp_device .model 	=	lp_device ->model ;
 	temp_device .length 	=	lp_device ->length ;
@@ -174,6 +222,7 @@ bool GParted_Core::parse_device( const Glib::ustring& device_path, Proc_Partitio
 	temp_device .sectors 	=	lp_device ->bios_geom .sectors ;
 	temp_device .cylinders	=	lp_device ->bios_geom .cylinders ;
 	temp_device .cylsize 	=	temp_device .heads * temp_device .sectors ;
+	ThroughputModel::add_device( device_path, temp_device .model, temp_device .length ) ;
 
 	//make sure cylsize is at least 1 MiB
 	if ( temp_device .cylsize < (MEBIBYTE / temp_device .sector_size) )
@@ -185,17 +234,14 @@ bool GParted_Core::parse_device( const Glib::ustring& device_path, Proc_Partitio
 		temp_device .disktype =	lp_disk ->type ->name ;
 		temp_device .max_prims = ped_disk_get_max_primary_partition_count( lp_disk ) ;
 
-		set_device_partitions( temp_device, lp_device, lp_disk ) ;
+		set_device_partitions( temp_device, lp_device, lp_disk, read_details ) ;
 		set_mountpoints( temp_device .partitions ) ;
-		set_used_sectors( temp_device .partitions, lp_disk ) ;
+		if ( read_details )
+			set_used_sectors( temp_device .partitions, lp_disk ) ;
+		temp_device .details_known = read_details ;
 
 		if ( temp_device .highest_busy )
-		{
-			temp_device .readonly = ! commit_to_os( lp_disk, 1 ) ;
-			//Clear libparted messages.  Typically these are:
-			//  The kernel was unable to re-read the partition table...
-			libparted_messages .clear() ;
-		}
+			temp_device .readonly = ! partition_table_matches_kernel( lp_disk, temp_device .partitions ) ;
 	}
 	//harddisk without disklabel
 	else
@@ -220,12 +266,19 @@ bool GParted_Core::parse_device( const Glib::ustring& device_path, Proc_Partitio
 						  libparted_messages .end() ) ;
 		libparted_messages .clear() ;
 		temp_device .partitions .push_back( partition_temp );
+		temp_device .details_known = true ;
 	}
 	close_device_and_disk( lp_device, lp_disk) ;
 	return true;
 }
-void GParted_Core::set_devices( std::vector<Device> & devices )
+void GParted_Core::set_devices( std::vector<Device> & devices, const Glib::ustring & first_device_path )
 {
+	Glib::RecMutex::Lock scan_lock( scan_mutex ) ;
+
+	//The file systems may have been used since they were checked
+	clean_checks .clear() ;
+	write_generations .clear() ;
+
 	devices .clear() ;
 	Device temp_device ;
 	Proc_Partitions_Info pp_info( true ) ;  //Refresh cache of proc partition information
@@ -233,8 +286,7 @@ void GParted_Core::set_devices( std::vector<Device> & devices )
 	DMRaid dmraid( true ) ;    //Refresh cache of dmraid device information
 	SWRaid swraid( true ) ;    //Refresh cache of swraid device information
 	LVM2_PV_Info lvm2_pv_info( true ) ;	//Refresh cache of LVM2 PV information
-	
-	init_maps() ;
+	Mount_Info mount_info( true ) ;	//Refresh cache of mount points
 	
 	//only probe if no devices were specified as arguments..
 	if ( probe_devices )
@@ -253,6 +305,8 @@ void GParted_Core::set_devices( std::vector<Device> & devices )
 			//Try to find all devices in /proc/partitions
 			for (unsigned int k=0; k < temp_devices .size(); k++)
 			{
+				if ( ! DeviceFilter::accept( temp_devices[ k ] ) )
+					continue ;
 				/*TO TRANSLATORS: looks like Scanning /dev/sda */
 				set_thread_status_message( String::ucompose ( _("Scanning %1"), temp_devices[ k ] ) ) ;
 				ped_device_get( temp_devices[ k ] .c_str() ) ;
@@ -263,6 +317,8 @@ void GParted_Core::set_devices( std::vector<Device> & devices )
 				std::vector<Glib::ustring> swraid_devices ;
 				swraid .get_devices( swraid_devices ) ;
 				for ( unsigned int k=0; k < swraid_devices .size(); k++ ) {
+					if ( ! DeviceFilter::accept( swraid_devices[k] ) )
+						continue ;
 					set_thread_status_message( String::ucompose ( _("Scanning %1"), swraid_devices[k] ) ) ;
 					ped_device_get( swraid_devices[k] .c_str() ) ;
 				}
@@ -273,6 +329,8 @@ void GParted_Core::set_devices( std::vector<Device> & devices )
 				std::vector<Glib::ustring> dmraid_devices ;
 				dmraid .get_devices( dmraid_devices ) ;
 				for ( unsigned int k=0; k < dmraid_devices .size(); k++ ) {
+					if ( ! DeviceFilter::accept( dmraid_devices[k] ) )
+						continue ;
 					set_thread_status_message( String::ucompose ( _("Scanning %1"), dmraid_devices[k] ) ) ;
 #ifndef USE_LIBPARTED_DMRAID
 					dmraid .create_dev_map_entries( dmraid_devices[k] ) ;
@@ -291,7 +349,13 @@ void GParted_Core::set_devices( std::vector<Device> & devices )
 		PedDevice* lp_device = ped_device_get_next( NULL ) ;
 		while ( lp_device ) 
 		{
-			//only add this device if we can read the first sector (which means it's a real device)
+			//only add this device if it passes the device filter and we can read the
+			//  first sector (which means it's a real device)
+			if ( ! DeviceFilter::accept( lp_device ->path ) )
+			{
+				lp_device = ped_device_get_next( lp_device ) ;
+				continue ;
+			}
 			char * buf = static_cast<char *>( malloc( lp_device ->sector_size ) ) ;
 			if ( buf )
 			{
@@ -345,17 +409,52 @@ void GParted_Core::set_devices( std::vector<Device> & devices )
 	}
 #endif
 
+	{
+		Glib::Mutex::Lock lock( scanned_devices_mutex ) ;
+		scanned_devices .clear() ;
+	}
+
+	//Scan first_device_path first, so the device the user was looking at is
+	//  shown again soonest.  Every device is handed to get_scanned_devices() as
+	//  soon as it is parsed, while devices keeps the order of device_paths.
+	//  Only the first device is read in detail, the details of the others are
+	//  read when they are selected or in the background.
+	std::vector<unsigned int> scan_order ;
 	for ( unsigned int t = 0 ; t < device_paths .size() ; t++ )
 	{
-		Device temp_device;
-		if( parse_device( device_paths[ t ], pp_info, temp_device ) )
-			devices .push_back( temp_device ) ;
+		if ( device_paths[ t ] == first_device_path )
+			scan_order .insert( scan_order .begin(), t ) ;
+		else
+			scan_order .push_back( t ) ;
 	}
 
-	//clear leftover information...	
-	//NOTE that we cannot clear mountinfo since it might be needed in get_all_mountpoints()
+	std::vector<Device> parsed_devices( device_paths .size() ) ;
+	std::vector<bool> parsed( device_paths .size(), false ) ;
+	for ( unsigned int t = 0 ; t < scan_order .size() ; t++ )
+	{
+		unsigned int index = scan_order[ t ] ;
+		if ( parse_device( device_paths[ index ], pp_info, parsed_devices[ index ], t == 0 ) )
+		{
+			parsed[ index ] = true ;
+
+			Glib::Mutex::Lock lock( scanned_devices_mutex ) ;
+			scanned_devices .push_back( parsed_devices[ index ] ) ;
+		}
+	}
+
+	for ( unsigned int t = 0 ; t < parsed_devices .size() ; t++ )
+		if ( parsed[ t ] )
+			devices .push_back( parsed_devices[ t ] ) ;
+
 	set_thread_status_message("") ;
-	fstab_info .clear() ;
+}
+
+//Move the devices scanned by set_devices() since the last call into devices
+void GParted_Core::get_scanned_devices( std::vector<Device> & devices )
+{
+	Glib::Mutex::Lock lock( scanned_devices_mutex ) ;
+	devices .insert( devices .end(), scanned_devices .begin(), scanned_devices .end() ) ;
+	scanned_devices .clear() ;
 }
 
 // runs gpart on the specified parameter
@@ -397,11 +496,13 @@ void GParted_Core::guess_partition_table(const Device & device, Glib::ustring &b
 void GParted_Core::set_thread_status_message( Glib::ustring msg )
 {
 	//Remember to clear status message when finished with thread.
+	Glib::Mutex::Lock lock( thread_status_message_mutex ) ;
 	thread_status_message = msg ;
 }
 
 Glib::ustring GParted_Core::get_thread_status_message( )
 {
+	Glib::Mutex::Lock lock( thread_status_message_mutex ) ;
 	return thread_status_message ;
 }
 
@@ -661,10 +762,81 @@ bool GParted_Core::snap_to_alignment( const Device & device, Partition & partiti
 	return rc ;
 }
 
+//Apply the operations, either a single one or several queued together on one
+//  partition, and set the result of each.  Operations following a failed one are
+//  not run.
+bool GParted_Core::apply_operations_to_disk( const std::vector<Operation *> & operations,
+                                             std::vector<OperationResult> & results,
+                                             bool more_operations )
+{
+	CoreSession session ;
+	std::vector<Glib::ustring> & libparted_messages = session .libparted_messages ;
+
+	//Operations applied in parallel take turns, except while they wait for a
+	//  command or copy blocks.  None is started once applying was cancelled.
+	if ( ! Utils::lock_operations() )
+	{
+		results .assign( operations .size(), RESULT_NOT_RUN ) ;
+		return false ;
+	}
+
+	//Keep partition tables open across the queued operations so that changes which
+	//  only touch the table are written and announced to the kernel once.  Steps which
+	//  need the kernel to see the new partitions flush them first.
+	session .table_session = true ;
+
+	std::vector<Glib::ustring> device_paths ;
+	device_paths .push_back( operations[ 0 ] ->device .get_path() ) ;
+	if ( operations[ 0 ] ->type == OPERATION_COPY )
+		device_paths .push_back( static_cast<OperationCopy*>( operations[ 0 ] ) ->partition_copied .device_path ) ;
+	IOThrottle::begin_operation( device_paths ) ;
+
+	results .assign( operations .size(), RESULT_NOT_RUN ) ;
+	bool succes ;
+	if ( operations .size() == 1 )
+	{
+		succes = apply_operation_to_disk( operations[ 0 ] ) ;
+		results[ 0 ] = succes ? RESULT_SUCCES : RESULT_ERROR ;
+	}
+	else
+		succes = apply_fused_operations_to_disk( operations, results ) ;
+
+	//Closing the partition tables and the libparted messages belong to the last
+	//  operation which ran
+	unsigned int last = operations .size() - 1 ;
+	while ( last > 0 && results[ last ] == RESULT_NOT_RUN )
+		last-- ;
+	Operation * operation = operations[ last ] ;
+
+	if ( ! succes || ! more_operations )
+	{
+		if ( ! close_partition_tables( operation ->operation_detail ) )
+		{
+			succes = false ;
+			results[ last ] = RESULT_ERROR ;
+		}
+	}
+	else
+		release_partition_tables() ;
+
+	IOThrottle::end_operation() ;
+
+	if ( libparted_messages .size() > 0 )
+	{
+		operation ->operation_detail .add_child( OperationDetail( _("libparted messages"), STATUS_INFO ) ) ;
+
+		for ( unsigned int t = 0 ; t < libparted_messages .size() ; t++ )
+			operation ->operation_detail .get_last_child() .add_child(
+				OperationDetail( libparted_messages[ t ], STATUS_NONE, FONT_ITALIC ) ) ;
+	}
+
+	Utils::unlock_operations() ;
+	return succes ;
+}
+
 bool GParted_Core::apply_operation_to_disk( Operation * operation )
 {
 	bool succes = false ;
-	libparted_messages .clear() ;
 
 	if ( calibrate_partition( operation ->partition_original, operation ->operation_detail ) )
 		switch ( operation ->type )
@@ -716,18 +888,128 @@ bool GParted_Core::apply_operation_to_disk( Operation * operation )
 				break ;
 		}
 
-	if ( libparted_messages .size() > 0 )
+	return succes ;
+}
+
+//Apply label, UUID and check operations queued together on one partition.  The
+//  partition is calibrated once and, where the file system tool can, the label
+//  and UUID are written by one command.
+bool GParted_Core::apply_fused_operations_to_disk( const std::vector<Operation *> & operations,
+                                                   std::vector<OperationResult> & results )
+{
+	Operation * operation_label = NULL ;
+	Operation * operation_uuid = NULL ;
+	for ( unsigned int t = 0 ; t < operations .size() ; t++ )
 	{
-		operation ->operation_detail .add_child( OperationDetail( _("libparted messages"), STATUS_INFO ) ) ;
+		if ( operations[ t ] ->type == OPERATION_LABEL_PARTITION )
+			operation_label = operations[ t ] ;
+		else if ( operations[ t ] ->type == OPERATION_CHANGE_UUID )
+			operation_uuid = operations[ t ] ;
+	}
 
-		for ( unsigned int t = 0 ; t < libparted_messages .size() ; t++ )
-			operation ->operation_detail .get_last_child() .add_child(
-				OperationDetail( libparted_messages[ t ], STATUS_NONE, FONT_ITALIC ) ) ;
+	bool succes = calibrate_partition( operations[ 0 ] ->partition_original, operations[ 0 ] ->operation_detail ) ;
+	if ( ! succes )
+		results[ 0 ] = RESULT_ERROR ;
+	bool label_and_uuid_written = false ;
+	for ( unsigned int t = 0 ; t < operations .size() && succes ; t++ )
+	{
+		Operation * operation = operations[ t ] ;
+		switch ( operation ->type )
+		{
+			case OPERATION_CHECK:
+				succes = check_repair_filesystem( operation ->partition_original, operation ->operation_detail ) &&
+					 maximize_filesystem( operation ->partition_original, operation ->operation_detail ) ;
+				break ;
+			case OPERATION_LABEL_PARTITION:
+			case OPERATION_CHANGE_UUID:
+				if ( operation_label && operation_uuid )
+				{
+					if ( label_and_uuid_written )
+					{
+						operation ->operation_detail .add_child( OperationDetail(
+								_("done together with the previous operation"),
+								STATUS_NONE,
+								FONT_ITALIC ) ) ;
+						break ;
+					}
+
+					Partition partition = operation_uuid ->partition_new ;
+					partition .set_label( operation_label ->partition_new .get_label() ) ;
+					succes = label_and_uuid( partition, operation ->operation_detail ) ;
+					label_and_uuid_written = true ;
+				}
+				else if ( operation ->type == OPERATION_LABEL_PARTITION )
+					succes = label_partition( operation ->partition_new, operation ->operation_detail ) ;
+				else
+					succes = change_uuid( operation ->partition_new, operation ->operation_detail ) ;
+				break ;
+			default:
+				succes = false ;
+				break ;
+		}
+		results[ t ] = succes ? RESULT_SUCCES : RESULT_ERROR ;
 	}
 
 	return succes ;
 }
 
+//Predict how long applying the operation takes, in seconds, following the steps
+//  apply_operation_to_disk() takes.  Changes to the partition table itself take
+//  little time compared to the file system commands and copying data.
+double GParted_Core::estimate_duration( const Operation * operation )
+{
+	const Partition & partition_original = operation ->partition_original ;
+	const Partition & partition_new = operation ->partition_new ;
+	switch ( operation ->type )
+	{
+		case OPERATION_CHECK:
+			//the file system is grown to fill the partition after the check
+			if ( get_fs( partition_original .filesystem ) .grow == FS::NONE )
+				return estimate_check( partition_original ) ;
+			return estimate_check( partition_original ) +
+			       ThroughputModel::estimate_command( "resize", partition_original .filesystem,
+			                                          partition_original .get_byte_length() ) ;
+		case OPERATION_CREATE:
+		case OPERATION_FORMAT:
+			if ( get_fs( partition_new .filesystem ) .create != FS::EXTERNAL )
+				return 0 ;
+			return ThroughputModel::estimate_command( "create", partition_new .filesystem,
+			                                          partition_new .get_byte_length() ) ;
+		case OPERATION_RESIZE_MOVE:
+		{
+			if ( partition_original .type == TYPE_EXTENDED )
+				return 0 ;
+			//the check before growing the file system to fill the partition is
+			//  skipped, as nothing wrote to it since the first check
+			if ( partition_new .sector_start == partition_original .sector_start )
+				return estimate_check( partition_original ) + estimate_resize( partition_original, partition_new ) ;
+
+			//shrink before moving, grow after moving, each with its own check
+			double seconds = estimate_check( partition_original ) +
+			                 estimate_data_move( partition_original, partition_new, true ) ;
+			if ( partition_new .get_sector_length() != partition_original .get_sector_length() )
+				seconds += estimate_check( partition_original ) +
+				           estimate_resize( partition_original, partition_new ) ;
+			return seconds ;
+		}
+		case OPERATION_COPY:
+		{
+			const Partition & partition_copied = static_cast<const OperationCopy *>( operation ) ->partition_copied ;
+			double seconds = estimate_check( partition_copied ) +
+			                 estimate_data_move( partition_copied, partition_new, false ) ;
+			if ( partition_new .get_sector_length() > partition_copied .get_sector_length() )
+				seconds += estimate_check( partition_new ) + estimate_resize( partition_copied, partition_new ) ;
+			return seconds ;
+		}
+		case OPERATION_LABEL_PARTITION:
+			return ThroughputModel::estimate_command( "label", partition_new .filesystem, 0 ) ;
+		case OPERATION_CHANGE_UUID:
+			return ThroughputModel::estimate_command( "uuid", partition_new .filesystem, 0 ) ;
+		default:
+			return 0 ;
+	}
+}
+
 bool GParted_Core::set_disklabel( const Glib::ustring & device_path, const Glib::ustring & disklabel ) 
 {
 	bool return_value = false ;
@@ -833,12 +1115,8 @@ std::vector<Glib::ustring> GParted_Core::get_disklabeltypes()
 
 std::vector<Glib::ustring> GParted_Core::get_all_mountpoints() 
 {
-	std::vector<Glib::ustring> mountpoints ;
-
-	for ( iter_mp = mount_info .begin() ; iter_mp != mount_info .end() ; ++iter_mp )
-		mountpoints .insert( mountpoints .end(), iter_mp ->second .begin(), iter_mp ->second .end() ) ;
-
-	return mountpoints ;
+	Mount_Info mount_info ;	//Use cache of mount points
+	return mount_info .get_all_mountpoints() ;
 }
 	
 std::map<Glib::ustring, bool> GParted_Core::get_available_flags( const Partition & partition ) 
@@ -876,95 +1154,158 @@ Glib::ustring GParted_Core::get_libparted_version()
 
 //private functions...
 
-void GParted_Core::init_maps() 
+//Return whether the kernel's view of the busy partitions agrees with the partition
+//  table read by libparted.  The kernel's view is read from /sys/block/<dev>/<part>/
+//  so it is only asked to re-read the table, which would also need a udev settle,
+//  when it is behind on partitions which aren't in use.
+bool GParted_Core::partition_table_matches_kernel( PedDisk* lp_disk, const std::vector<Partition> & partitions )
 {
-	mount_info .clear() ;
-	fstab_info .clear() ;
+	std::vector<Glib::ustring> & libparted_messages = get_libparted_messages() ;
 
-	read_mountpoints_from_file( "/proc/mounts", mount_info ) ;
-	read_mountpoints_from_file_swaps( "/proc/swaps", mount_info ) ;
-	read_mountpoints_from_file( "/etc/mtab", mount_info ) ;
-	read_mountpoints_from_file( "/etc/fstab", fstab_info ) ;
-	
-	//sort the mount points and remove duplicates.. (no need to do this for fstab_info)
-	for ( iter_mp = mount_info .begin() ; iter_mp != mount_info .end() ; ++iter_mp )
-	{
-		std::sort( iter_mp ->second .begin(), iter_mp ->second .end() ) ;
-		
-		iter_mp ->second .erase( 
-				std::unique( iter_mp ->second .begin(), iter_mp ->second .end() ),
-				iter_mp ->second .end() ) ;
-	}
-}
-
-void GParted_Core::read_mountpoints_from_file(
-	const Glib::ustring & filename,
-	std::map< Glib::ustring, std::vector<Glib::ustring> > & map )
-{
-	FS_Info fs_info ;  //Use cache of file system information
+	//On "loop" partition tables the partition is the device
+	if ( ! strcmp( lp_disk ->type ->name, "loop" ) )
+		return true ;
 
-	FILE* fp = setmntent( filename .c_str(), "r" ) ;
+#ifndef USE_LIBPARTED_DMRAID
+	//dmraid partitions are dev mapper entries, not kernel partitions
+	DMRaid dmraid ;
+	if ( dmraid .is_dmraid_device( lp_disk ->dev ->path ) )
+		return true ;
+#endif
 
-	if ( fp == NULL )
-		return ;
+	//Name of the device in sysfs, e.g. /dev/cciss/c0d0 -> cciss!c0d0
+	Glib::ustring device_name ;
+	char * real_path = realpath( lp_disk ->dev ->path, NULL ) ;
+	if ( real_path )
+	{
+		device_name = real_path ;
+		free( real_path ) ;
+	}
+	if ( device_name .substr( 0, 5 ) == "/dev/" )
+		device_name = device_name .substr( 5 ) ;
+	for ( unsigned int t = 0 ; t < device_name .length() ; t++ )
+		if ( device_name[ t ] == '/' )
+			device_name .replace( t, 1, "!" ) ;
+
+	Glib::ustring sysfs_dir = "/sys/block/" + device_name ;
+	DIR * dir = NULL ;
+	if ( device_name .empty() || ! ( dir = opendir( sysfs_dir .c_str() ) ) )
+	{
+		//No sysfs information, so fall back to asking the kernel to re-read the table
+		bool succes = commit_to_os( lp_disk, 1 ) ;
+		//Clear libparted messages.  Typically these are:
+		//  The kernel was unable to re-read the partition table...
+		libparted_messages .clear() ;
+		return succes ;
+	}
 
-	struct mntent* p = NULL ;
+	//Partitions known to the kernel by partition number, as start and size in 512 byte
+	//  units, and their names
+	std::map< int, std::pair<Sector, Sector> > kernel_partitions ;
+	std::map< int, Glib::ustring > kernel_names ;
+	struct dirent * entry ;
+	while ( ( entry = readdir( dir ) ) )
+	{
+		Glib::ustring partition_dir = sysfs_dir + "/" + entry ->d_name ;
+		std::ifstream number_file( ( partition_dir + "/partition" ) .c_str() ) ;
+		std::ifstream start_file( ( partition_dir + "/start" ) .c_str() ) ;
+		std::ifstream size_file( ( partition_dir + "/size" ) .c_str() ) ;
+
+		int number ;
+		Sector start, size ;
+		if ( number_file >> number && start_file >> start && size_file >> size )
+		{
+			kernel_partitions[ number ] = std::make_pair( start, size ) ;
+			kernel_names[ number ] = entry ->d_name ;
+		}
+	}
+	closedir( dir ) ;
 
-	while ( (p = getmntent(fp)) != NULL )
+	//Busy partitions by partition number
+	std::set<int> busy_numbers ;
+	for ( unsigned int t = 0 ; t < partitions .size() ; t++ )
 	{
-		Glib::ustring node = p->mnt_fsname ;
+		if ( partitions[ t ] .busy )
+			busy_numbers .insert( partitions[ t ] .partition_number ) ;
+		for ( unsigned int k = 0 ; k < partitions[ t ] .logicals .size() ; k++ )
+			if ( partitions[ t ] .logicals[ k ] .busy )
+				busy_numbers .insert( partitions[ t ] .logicals[ k ] .partition_number ) ;
+	}
 
-		Glib::ustring uuid = Utils::regexp_label( node, "^UUID=(.*)" ) ;
-		if ( ! uuid .empty() )
-			node = fs_info .get_path_by_uuid( uuid ) ;
+	//A difference in a busy partition can't be fixed while it is in use, so the
+	//  device is read-only.  Other differences are fixed by asking the kernel to
+	//  re-read the table, as it can let go of those partitions.
+	Sector scale = lp_disk ->dev ->sector_size / 512 ;
+	std::set<int> table_numbers ;
+	bool kernel_outdated = false ;
+	for ( PedPartition* lp_partition = ped_disk_next_partition( lp_disk, NULL ) ;
+	      lp_partition ;
+	      lp_partition = ped_disk_next_partition( lp_disk, lp_partition ) )
+	{
+		if ( lp_partition ->num <= 0 )
+			continue ;
+		table_numbers .insert( lp_partition ->num ) ;
+
+		//The kernel only maps the first sectors of an extended partition
+		std::map< int, std::pair<Sector, Sector> >::iterator iter = kernel_partitions .find( lp_partition ->num ) ;
+		if ( iter == kernel_partitions .end() ||
+		     iter ->second .first != lp_partition ->geom .start * scale ||
+		     ( ! ( lp_partition ->type & PED_PARTITION_EXTENDED ) &&
+		       iter ->second .second != lp_partition ->geom .length * scale ) )
+		{
+			if ( busy_numbers .count( lp_partition ->num ) )
+				return false ;
+			kernel_outdated = true ;
+		}
+	}
 
-		Glib::ustring label = Utils::regexp_label( node, "^LABEL=(.*)" ) ;
-		if ( ! label .empty() )
-			node = fs_info .get_path_by_label( label ) ;
+	//A partition the kernel knows about but which is gone from the table
+	Mount_Info mount_info ;	//Use cache of mount points
+	for ( std::map< int, std::pair<Sector, Sector> >::iterator iter = kernel_partitions .begin() ;
+	      iter != kernel_partitions .end() ;
+	      ++iter )
+	{
+		if ( table_numbers .count( iter ->first ) )
+			continue ;
 
-		if ( ! node .empty() )
-		{
-			Glib::ustring mountpoint = p->mnt_dir ;
+		//Name of the partition in sysfs, e.g. cciss!c0d0p1 -> /dev/cciss/c0d0p1
+		Glib::ustring partition_path = "/dev/" + kernel_names[ iter ->first ] ;
+		for ( unsigned int t = 5 ; t < partition_path .length() ; t++ )
+			if ( partition_path[ t ] == '!' )
+				partition_path .replace( t, 1, "/" ) ;
 
-			//Only add node path(s) if mount point exists
-			if ( file_test( mountpoint, Glib::FILE_TEST_EXISTS ) )
-			{
-				map[ node ] .push_back( mountpoint ) ;
+		if ( mount_info .is_mounted( partition_path ) ||
+		     kernel_partition_has_holders( sysfs_dir + "/" + kernel_names[ iter ->first ] ) )
+			return false ;
+		kernel_outdated = true ;
+	}
 
-				//If node is a symbolic link (e.g., /dev/root)
-				//  then find real path and add entry
-				if ( file_test( node, Glib::FILE_TEST_IS_SYMLINK ) )
-				{
-					char c_str[4096+1] ;
-					//FIXME: it seems realpath is very unsafe to use (manpage)...
-					if ( realpath( node .c_str(), c_str ) != NULL )
-						map[ c_str ] .push_back( mountpoint ) ;
-				}
-			}
-		}
+	if ( kernel_outdated )
+	{
+		bool succes = commit_to_os( lp_disk, 1 ) ;
+		//Clear libparted messages, as above
+		libparted_messages .clear() ;
+		return succes ;
 	}
 
-	endmntent( fp ) ;
+	return true ;
 }
 
-void GParted_Core::read_mountpoints_from_file_swaps(
-	const Glib::ustring & filename,
-	std::map< Glib::ustring, std::vector<Glib::ustring> > & map )
+//Whether something, like a device-mapper or software RAID device, is built on
+//  the partition known to the kernel at partition_dir in sysfs
+bool GParted_Core::kernel_partition_has_holders( const Glib::ustring & partition_dir )
 {
-	std::string line ;
-	std::string node ;
-	
-	std::ifstream file( filename .c_str() ) ;
-	if ( file )
-	{
-		while ( getline( file, line ) )
-		{
-			node = Utils::regexp_label( line, "^(/[^ ]+)" ) ;
-			if ( node .size() > 0 )
-				map[ node ] .push_back( "" /* no mountpoint for swap */ ) ;
-		}
-		file .close() ;
-	}
+	DIR * dir = opendir( ( partition_dir + "/holders" ) .c_str() ) ;
+	if ( ! dir )
+		return false ;
+
+	bool holders = false ;
+	struct dirent * entry ;
+	while ( ! holders && ( entry = readdir( dir ) ) )
+		holders = strcmp( entry ->d_name, "." ) && strcmp( entry ->d_name, ".." ) ;
+	closedir( dir ) ;
+
+	return holders ;
 }
 
 Glib::ustring GParted_Core::get_partition_path( PedPartition * lp_partition )
@@ -1006,11 +1347,14 @@ Glib::ustring GParted_Core::get_partition_path( PedPartition * lp_partition )
  * Fills the device.partitions member of device by scanning
  * all partitions
  */
-void GParted_Core::set_device_partitions( Device & device, PedDevice* lp_device, PedDisk* lp_disk )
+void GParted_Core::set_device_partitions( Device & device, PedDevice* lp_device, PedDisk* lp_disk, bool read_details )
 {
+	std::vector<Glib::ustring> & libparted_messages = get_libparted_messages() ;
+
 	int EXT_INDEX = -1 ;
 	Proc_Partitions_Info pp_info ; //Use cache of proc partitions information
 	FS_Info fs_info ;  //Use cache of file system information
+	Mount_Info mount_info ;	//Use cache of mount points
 #ifndef USE_LIBPARTED_DMRAID
 	DMRaid dmraid ;    //Use cache of dmraid device information
 #endif
@@ -1019,6 +1363,11 @@ void GParted_Core::set_device_partitions( Device & device, PedDevice* lp_device,
 	//clear partitions
 	device .partitions .clear() ;
 
+	//Read the signature areas of all partitions in a single forward sweep over
+	//  the device, instead of seeking back and forth for each partition
+	std::map<int, PartitionMagic> magics ;
+	read_partition_magic( lp_device, lp_disk, magics ) ;
+
 	PedPartition* lp_partition = ped_disk_next_partition( lp_disk, NULL ) ;
 	while ( lp_partition )
 	{
@@ -1034,13 +1383,13 @@ void GParted_Core::set_device_partitions( Device & device, PedDevice* lp_device,
 		{
 			case PED_PARTITION_NORMAL:
 			case PED_PARTITION_LOGICAL:
-				filesystem = get_filesystem( lp_device, lp_partition, partition_temp .messages ) ;
+				filesystem = get_filesystem( lp_partition, magics[ lp_partition ->num ],
+				                             partition_temp .messages ) ;
 
 				/* ped_partition_is_busy returns false for busy partitions inside luks containers
 				 * TODO: submit bug to libparted
 				 */
-				iter_mp = mount_info.find( partition_path );
-				if ( iter_mp != mount_info .end() )
+				if ( mount_info .is_mounted( partition_path ) )
 					partition_is_busy = true ;
 
 #ifndef USE_LIBPARTED_DMRAID
@@ -1050,12 +1399,10 @@ void GParted_Core::set_device_partitions( Device & device, PedDevice* lp_device,
 				if ( dmraid .is_dmraid_device( device .get_path() ) )
 				{
 					//Try device_name + partition_number
-					iter_mp = mount_info .find( device .get_path() + Utils::num_to_str( lp_partition ->num ) ) ;
-					if ( iter_mp != mount_info .end() )
+					if ( mount_info .is_mounted( device .get_path() + Utils::num_to_str( lp_partition ->num ) ) )
 						partition_is_busy = true ;
 					//Try device_name + p + partition_number
-					iter_mp = mount_info .find( device .get_path() + "p" + Utils::num_to_str( lp_partition ->num ) ) ;
-					if ( iter_mp != mount_info .end() )
+					if ( mount_info .is_mounted( device .get_path() + "p" + Utils::num_to_str( lp_partition ->num ) ) )
 						partition_is_busy = true ;
 				}
 #endif
@@ -1082,7 +1429,7 @@ void GParted_Core::set_device_partitions( Device & device, PedDevice* lp_device,
 				partition_temp .add_paths( pp_info .get_alternate_paths( partition_temp .get_path() ) ) ;
 				set_flags( partition_temp, lp_partition ) ;
 
-				if( filesystem == GParted::FS_LUKS && partition_is_busy)
+				if( read_details && filesystem == GParted::FS_LUKS && partition_is_busy)
 					luks::set_contained_partition( partition_temp );
 
 				if ( partition_temp .busy && partition_temp .partition_number > device .highest_busy )
@@ -1100,12 +1447,10 @@ void GParted_Core::set_device_partitions( Device & device, PedDevice* lp_device,
 					for ( unsigned int k = 5; k < 255; k++ )
 					{
 						//Try device_name + [5 to 255]
-						iter_mp = mount_info .find( device .get_path() + Utils::num_to_str( k ) ) ;
-						if ( iter_mp != mount_info .end() )
+						if ( mount_info .is_mounted( device .get_path() + Utils::num_to_str( k ) ) )
 							partition_is_busy = true ;
 						//Try device_name + p + [5 to 255]
-						iter_mp = mount_info .find( device .get_path() + "p" + Utils::num_to_str( k ) ) ;
-						if ( iter_mp != mount_info .end() )
+						if ( mount_info .is_mounted( device .get_path() + "p" + Utils::num_to_str( k ) ) )
 							partition_is_busy = true ;
 					}
 				}
@@ -1135,7 +1480,7 @@ void GParted_Core::set_device_partitions( Device & device, PedDevice* lp_device,
 		}
 
 		//Avoid reading additional file system information if there is no path
-		if ( partition_temp .get_path() != "" )
+		if ( read_details && partition_temp .get_path() != "" )
 		{
 			//Retrieve file system label
 			//  Use file system specific method first in an effort to ensure multi-byte
@@ -1186,29 +1531,88 @@ void GParted_Core::set_device_partitions( Device & device, PedDevice* lp_device,
 	insert_unallocated( device .get_path(), device .partitions, 0, device .length -1, device .sector_size, false ) ; 
 }
 
-GParted::FILESYSTEM GParted_Core::get_filesystem( PedDevice* lp_device, PedPartition* lp_partition,
-                                                  std::vector<Glib::ustring>& messages )
+//Areas of a partition holding file system signatures not detected by libparted
+const Byte_Value MAGIC_HEAD_SIZE  = 1024 ;		//LUKS at 0, LVM2 label at 512
+const Byte_Value MAGIC_64K_OFFSET = 64 * 1024 ;		//reiser4 and btrfs super blocks
+const Byte_Value MAGIC_64K_SIZE   = 4096 ;
+
+struct MagicRead
 {
-	char magic1[16] = "";
-	char magic2[16] = "";
+	Sector sector ;
+	Sector count ;
+	int num ;
+	bool head ;
+
+	bool operator<( const MagicRead & other ) const
+	{
+		return sector < other .sector ;
+	}
+} ;
 
+//Read the signature areas of all partitions on the device, in order of position on
+//  the device and opening the device only once.  Areas which extend beyond the end
+//  of a partition are left empty.
+void GParted_Core::read_partition_magic( PedDevice* lp_device, PedDisk* lp_disk,
+                                         std::map<int, PartitionMagic> & magics )
+{
+	Byte_Value sector_size = lp_device ->sector_size ;
+	Sector head_count = ( MAGIC_HEAD_SIZE + sector_size - 1 ) / sector_size ;
+	Sector super_count = ( MAGIC_64K_SIZE + sector_size - 1 ) / sector_size ;
+
+	std::vector<MagicRead> reads ;
+	for ( PedPartition* lp_partition = ped_disk_next_partition( lp_disk, NULL ) ;
+	      lp_partition ;
+	      lp_partition = ped_disk_next_partition( lp_disk, lp_partition ) )
+	{
+		if ( lp_partition ->type != PED_PARTITION_NORMAL && lp_partition ->type != PED_PARTITION_LOGICAL )
+			continue ;
+
+		MagicRead read ;
+		read .num = lp_partition ->num ;
+
+		read .sector = lp_partition ->geom .start ;
+		read .count = head_count ;
+		read .head = true ;
+		if ( read .count <= lp_partition ->geom .length )
+			reads .push_back( read ) ;
+
+		read .sector = lp_partition ->geom .start + MAGIC_64K_OFFSET / sector_size ;
+		read .count = super_count ;
+		read .head = false ;
+		if ( MAGIC_64K_OFFSET / sector_size + read .count <= lp_partition ->geom .length )
+			reads .push_back( read ) ;
+	}
+
+	if ( reads .empty() || ! ped_device_open( lp_device ) )
+		return ;
+
+	std::sort( reads .begin(), reads .end() ) ;
+	for ( unsigned int t = 0 ; t < reads .size() ; t++ )
+	{
+		std::vector<char> buf( reads[ t ] .count * sector_size ) ;
+		if ( ! ped_device_read( lp_device, & buf[ 0 ], reads[ t ] .sector, reads[ t ] .count ) )
+			continue ;
+
+		if ( reads[ t ] .head )
+			magics[ reads[ t ] .num ] .head .swap( buf ) ;
+		else
+			magics[ reads[ t ] .num ] .super64k .swap( buf ) ;
+	}
+
+	ped_device_close( lp_device ) ;
+}
+
+GParted::FILESYSTEM GParted_Core::get_filesystem( PedPartition* lp_partition,
+                                                  const PartitionMagic & magic,
+                                                  std::vector<Glib::ustring>& messages )
+{
 	//Check for LUKS encryption prior to libparted file system detection.
 	//  Otherwise encrypted file systems such as ext3 will be detected by
 	//  libparted as 'ext3'.
 
 	//LUKS encryption
-	char * buf = static_cast<char *>( malloc( lp_device ->sector_size ) ) ;
-	if ( buf )
-	{
-		ped_device_open( lp_device );
-		ped_geometry_read( & lp_partition ->geom, buf, 0, 1 ) ;
-		memcpy(magic1, buf+0, 6) ;  //set binary magic data
-		ped_device_close( lp_device );
-		free( buf ) ;
-
-		if ( 0 == memcmp( magic1 , "LUKS\xBA\xBE", 6 ) )
-			return GParted::FS_LUKS ;
-	}
+	if ( magic .head .size() >= MAGIC_HEAD_SIZE && 0 == memcmp( & magic .head[ 0 ], "LUKS\xBA\xBE", 6 ) )
+		return GParted::FS_LUKS ;
 
 	FS_Info fs_info ;
 	Glib::ustring fs_type = "" ;
@@ -1286,68 +1690,23 @@ GParted::FILESYSTEM GParted_Core::get_filesystem( PedDevice* lp_device, PedParti
 	// - no patches sent to parted for lvm2, or luks
 
 	//reiser4
-	buf = static_cast<char *>( malloc( lp_device ->sector_size ) ) ;
-	if ( buf )
-	{
-		ped_device_open( lp_device );
-		ped_geometry_read( & lp_partition ->geom
-		                 , buf
-		                 , (65536 / lp_device ->sector_size) 
-		                 , 1
-		                 ) ;
-		memcpy(magic1, buf+0, 7) ; //set binary magic data
-		ped_device_close( lp_device );
-		free( buf ) ;
-
-		if ( 0 == memcmp( magic1, "ReIsEr4", 7 ) )
-			return GParted::FS_REISER4 ;
-	}
+	if ( magic .super64k .size() >= MAGIC_64K_SIZE && 0 == memcmp( & magic .super64k[ 0 ], "ReIsEr4", 7 ) )
+		return GParted::FS_REISER4 ;
 
 	//lvm2
 	//NOTE: lvm2 is not a file system but we do wish to recognize the Physical Volume
-	buf = static_cast<char *>( malloc( lp_device ->sector_size ) ) ;
-	if ( buf )
+	if (    magic .head .size() >= MAGIC_HEAD_SIZE
+	     && 0 == memcmp( & magic .head[ 512 + 0 ], "LABELONE", 8 )
+	     && 0 == memcmp( & magic .head[ 512 + 24 ], "LVM2", 4 ) )
 	{
-		ped_device_open( lp_device );
-		if ( lp_device ->sector_size == 512 )
-		{
-			ped_geometry_read( & lp_partition ->geom, buf, 1, 1 ) ;
-			memcpy(magic1, buf+ 0, 8) ; // set binary magic data
-			memcpy(magic2, buf+24, 4) ; // set binary magic data
-		}
-		else
-		{
-			ped_geometry_read( & lp_partition ->geom, buf, 0, 1 ) ;
-			memcpy(magic1, buf+ 0+512, 8) ; // set binary magic data
-			memcpy(magic2, buf+24+512, 4) ; // set binary magic data
-		}
-		ped_device_close( lp_device );
-		free( buf ) ;
-
-		if (    0 == memcmp( magic1, "LABELONE", 8 )
-		     && 0 == memcmp( magic2, "LVM2", 4 ) )
-		{
-			return GParted::FS_LVM2_PV ;
-		}
+		return GParted::FS_LVM2_PV ;
 	}
 
 	//btrfs
-	const Sector BTRFS_SUPER_INFO_SIZE   = 4096 ;
-	const Sector BTRFS_SUPER_INFO_OFFSET = (64 * 1024) ;
 	const char* const BTRFS_SIGNATURE  = "_BHRfS_M" ;
 
-	char    buf_btrfs[BTRFS_SUPER_INFO_SIZE] ;
-
-	ped_device_open( lp_device ) ;
-	ped_geometry_read( & lp_partition ->geom
-	                 , buf_btrfs
-	                 , (BTRFS_SUPER_INFO_OFFSET / lp_device ->sector_size)
-	                 , (BTRFS_SUPER_INFO_SIZE / lp_device ->sector_size)
-	                 ) ;
-	memcpy(magic1, buf_btrfs+64, strlen(BTRFS_SIGNATURE) ) ;  //set binary magic data
-	ped_device_close( lp_device ) ;
-
-	if ( 0 == memcmp( magic1, BTRFS_SIGNATURE, strlen(BTRFS_SIGNATURE) ) )
+	if (    magic .super64k .size() >= MAGIC_64K_SIZE
+	     && 0 == memcmp( & magic .super64k[ 64 ], BTRFS_SIGNATURE, strlen(BTRFS_SIGNATURE) ) )
 	{
 		return GParted::FS_BTRFS ;
 	}
@@ -1469,6 +1828,7 @@ void GParted_Core::insert_unallocated( const Glib::ustring & device_path,
 	
 void GParted_Core::set_mountpoints( std::vector<Partition> & partitions ) 
 {
+	Mount_Info mount_info ;	//Use cache of mount points
 #ifndef USE_LIBPARTED_DMRAID
 	DMRaid dmraid ;	//Use cache of dmraid device information
 #endif
@@ -1493,17 +1853,15 @@ void GParted_Core::set_mountpoints( std::vector<Partition> & partitions )
 				if ( dmraid .is_dmraid_device( partitions[ t ] .device_path ) )
 				{
 					//Try device_name + partition_number
-					iter_mp = mount_info .find( partitions[ t ] .device_path + Utils::num_to_str( partitions[ t ] .partition_number ) ) ;
-					if ( iter_mp != mount_info .end() )
+					if ( mount_info .is_mounted( partitions[ t ] .device_path + Utils::num_to_str( partitions[ t ] .partition_number ) ) )
 					{
-						partitions[ t ] .add_mountpoints( iter_mp ->second ) ;
+						partitions[ t ] .add_mountpoints( mount_info .get_mounted_mountpoints( partitions[ t ] .device_path + Utils::num_to_str( partitions[ t ] .partition_number ) ) ) ;
 						break ;
 					}
 					//Try device_name + p + partition_number
-					iter_mp = mount_info .find( partitions[ t ] .device_path + "p" + Utils::num_to_str( partitions[ t ] .partition_number ) ) ;
-					if ( iter_mp != mount_info .end() )
+					if ( mount_info .is_mounted( partitions[ t ] .device_path + "p" + Utils::num_to_str( partitions[ t ] .partition_number ) ) )
 					{
-						partitions[ t ] .add_mountpoints( iter_mp ->second ) ;
+						partitions[ t ] .add_mountpoints( mount_info .get_mounted_mountpoints( partitions[ t ] .device_path + "p" + Utils::num_to_str( partitions[ t ] .partition_number ) ) ) ;
 						break ;
 					}
 				}
@@ -1513,10 +1871,9 @@ void GParted_Core::set_mountpoints( std::vector<Partition> & partitions )
 					//Normal device, not DMRaid device
 					for ( unsigned int i = 0 ; i < partitions[ t ] .get_paths() .size() ; i++ )
 					{
-						iter_mp = mount_info .find( partitions[ t ] .get_paths()[ i ] ) ;
-						if ( iter_mp != mount_info .end() )
+						if ( mount_info .is_mounted( partitions[ t ] .get_paths()[ i ] ) )
 						{
-							partitions[ t ] .add_mountpoints( iter_mp ->second ) ;
+							partitions[ t ] .add_mountpoints( mount_info .get_mounted_mountpoints( partitions[ t ] .get_paths()[ i ] ) ) ;
 							break ;
 						}
 					}
@@ -1529,9 +1886,7 @@ void GParted_Core::set_mountpoints( std::vector<Partition> & partitions )
 			}
 			else
 			{
-				iter_mp = fstab_info .find( partitions[ t ] .get_path() );
-				if ( iter_mp != fstab_info .end() )
-					partitions[ t ] .add_mountpoints( iter_mp ->second ) ;
+				partitions[ t ] .add_mountpoints( mount_info .get_fstab_mountpoints( partitions[ t ] .get_path() ) ) ;
 			}
 		}
 		else if ( partitions[ t ] .type == GParted::TYPE_EXTENDED )
@@ -1710,6 +2065,48 @@ void GParted_Core::set_flags( Partition & partition, PedPartition* lp_partition
 			partition .flags .push_back( ped_partition_flag_get_name( flags[ t ] ) ) ;
 }
 
+double GParted_Core::estimate_check( const Partition & partition )
+{
+	if ( get_fs( partition .filesystem ) .check != FS::EXTERNAL )
+		return 0 ;
+
+	return ThroughputModel::estimate_command( "check", partition .filesystem, partition .get_byte_length() ) ;
+}
+
+//Time to change the file system size, without the checks done before
+double GParted_Core::estimate_resize( const Partition & partition_old, const Partition & partition_new )
+{
+	const FS & fs = get_fs( partition_old .filesystem ) ;
+	if ( partition_new .get_sector_length() < partition_old .get_sector_length() )
+		return fs .shrink == FS::NONE ? 0 : ThroughputModel::estimate_command(
+				"resize", partition_new .filesystem, partition_new .get_byte_length() ) ;
+
+	if ( fs .grow == FS::NONE || partition_new .get_sector_length() == partition_old .get_sector_length() )
+		return 0 ;
+
+	return ThroughputModel::estimate_command( "resize", partition_new .filesystem, partition_new .get_byte_length() ) ;
+}
+
+//Time to move or copy the data of a file system.  The internal algorithm copies the
+//  whole partition, and first reads it all when source and destination overlap.
+//  Commands only copy the used space.
+double GParted_Core::estimate_data_move( const Partition & partition_src, const Partition & partition_dst, bool move )
+{
+	const FS & fs = get_fs( partition_src .filesystem ) ;
+	FS::Support action = move ? fs .move : fs .copy ;
+	if ( action == FS::NONE )
+		return 0 ;
+
+	Byte_Value bytes = std::min( partition_src .get_byte_length(), partition_dst .get_byte_length() ) ;
+	if ( action != FS::GPARTED && partition_src .get_sectors_used() >= 0 )
+		bytes = std::min( bytes, partition_src .get_sectors_used() * partition_src .sector_size ) ;
+
+	double seconds = ThroughputModel::estimate_copy( partition_src .device_path, partition_dst .device_path, bytes ) ;
+	if ( action == FS::GPARTED && move && partition_dst .test_overlap( partition_src ) )
+		seconds += ThroughputModel::estimate_read( partition_src .device_path, bytes ) ;
+	return seconds ;
+}
+
 bool GParted_Core::create( const Device & device, Partition & new_partition, OperationDetail & operationdetail ) 
 {
 	if ( new_partition .type == GParted::TYPE_EXTENDED )   
@@ -1837,11 +2234,16 @@ bool GParted_Core::create_partition( Partition & new_partition, OperationDetail
 	
 bool GParted_Core::create_filesystem( const Partition & partition, OperationDetail & operationdetail ) 
 {
+	if ( ! flush_partition_tables( operationdetail ) )
+		return false ;
+
 	/*TO TRANSLATORS: looks like create new ext3 file system */ 
 	operationdetail .add_child( OperationDetail( String::ucompose(
 							_("create new %1 file system"),
 							Utils::get_filesystem_string( partition .filesystem ) ) ) ) ;
 	
+	note_filesystem_written( partition ) ;
+
 	bool succes = false ;
 	FileSystem* p_filesystem = NULL ;
 	switch ( get_fs( partition .filesystem ) .create )
@@ -1855,10 +2257,16 @@ bool GParted_Core::create_filesystem( const Partition & partition, OperationDeta
 			break ;
 #endif
 		case GParted::FS::EXTERNAL:
+		{
+			Glib::Timer timer ;
 			succes = ( p_filesystem = set_proper_filesystem( partition .filesystem ) ) &&
 				 p_filesystem ->create( partition, operationdetail .get_last_child() ) ;
+			if ( succes )
+				ThroughputModel::record_command( "create", partition .filesystem,
+				                                 partition .get_byte_length(), timer .elapsed() ) ;
 
 			break ;
+		}
 
 		default:
 			break ;
@@ -1925,6 +2333,8 @@ bool GParted_Core::Delete( const Partition & partition, OperationDetail & operat
 
 bool GParted_Core::remove_filesystem( const Partition & partition, OperationDetail & operationdetail )
 {
+	note_filesystem_written( partition ) ;
+
 	bool success = true ;
 	FileSystem* p_filesystem = NULL ;
 
@@ -1934,6 +2344,9 @@ bool GParted_Core::remove_filesystem( const Partition & partition, OperationDeta
 			//Run file system specific remove method to delete the file system.  Most
 			//  file systems should NOT implement a remove() method as it will prevent
 			//  recovery from accidental partition deletion.
+			if ( ! flush_partition_tables( operationdetail ) )
+				return false ;
+
 			operationdetail .add_child( OperationDetail( String::ucompose(
 								_("delete %1 file system"),
 								Utils::get_filesystem_string( partition .filesystem ) ) ) ) ;
@@ -1950,6 +2363,9 @@ bool GParted_Core::remove_filesystem( const Partition & partition, OperationDeta
 
 bool GParted_Core::label_partition( const Partition & partition, OperationDetail & operationdetail )	
 {
+	if ( ! flush_partition_tables( operationdetail ) )
+		return false ;
+
 	if( partition .get_label() .empty() ) {
 		operationdetail .add_child( OperationDetail( String::ucompose(
 														_("Clear partition label on %1"),
@@ -1962,6 +2378,8 @@ bool GParted_Core::label_partition( const Partition & partition, OperationDetail
 													 ) ) ) ;
 	}
 
+	note_filesystem_written( partition ) ;
+
 	bool succes = false ;
 	FileSystem* p_filesystem = NULL ;
 	if ( partition .type != TYPE_EXTENDED )
@@ -1969,9 +2387,14 @@ bool GParted_Core::label_partition( const Partition & partition, OperationDetail
 		switch( get_fs( partition .filesystem ) .write_label )
 		{
 			case FS::EXTERNAL:
+			{
+				Glib::Timer timer ;
 				succes = ( p_filesystem = set_proper_filesystem( partition .filesystem ) ) &&
 					 p_filesystem ->write_label( partition, operationdetail .get_last_child() ) ;
+				if ( succes )
+					ThroughputModel::record_command( "label", partition .filesystem, 0, timer .elapsed() ) ;
 				break ;
+			}
 #ifndef HAVE_LIBPARTED_3_0_0_PLUS
 			case FS::LIBPARTED:
 				break ;
@@ -1989,6 +2412,9 @@ bool GParted_Core::label_partition( const Partition & partition, OperationDetail
 
 bool GParted_Core::change_uuid( const Partition & partition, OperationDetail & operationdetail )
 {
+	if ( ! flush_partition_tables( operationdetail ) )
+		return false ;
+
 	if ( partition .uuid == UUID_RANDOM_NTFS_HALF ) {
 		operationdetail .add_child( OperationDetail( String::ucompose(
 										_("Set half of the UUID on %1 to a new, random value"),
@@ -2001,6 +2427,8 @@ bool GParted_Core::change_uuid( const Partition & partition, OperationDetail & o
 									 ) ) ) ;
 	}
 
+	note_filesystem_written( partition ) ;
+
 	bool succes = false ;
 	FileSystem* p_filesystem = NULL ;
 	if ( partition .type != TYPE_EXTENDED )
@@ -2008,9 +2436,14 @@ bool GParted_Core::change_uuid( const Partition & partition, OperationDetail & o
 		switch( get_fs( partition .filesystem ) .write_uuid )
 		{
 			case FS::EXTERNAL:
+			{
+				Glib::Timer timer ;
 				succes = ( p_filesystem = set_proper_filesystem( partition .filesystem ) ) &&
 					 p_filesystem ->write_uuid( partition, operationdetail .get_last_child() ) ;
+				if ( succes )
+					ThroughputModel::record_command( "uuid", partition .filesystem, 0, timer .elapsed() ) ;
 				break ;
+			}
 
 			default:
 				break;
@@ -2022,6 +2455,46 @@ bool GParted_Core::change_uuid( const Partition & partition, OperationDetail & o
 	return succes ;
 }
 
+//Write the label and a new UUID in one go, or one after the other when the file
+//  system can't do both
+bool GParted_Core::label_and_uuid( const Partition & partition, OperationDetail & operationdetail )
+{
+	if (    partition .type == TYPE_EXTENDED
+	     || get_fs( partition .filesystem ) .write_label != FS::EXTERNAL
+	     || get_fs( partition .filesystem ) .write_uuid != FS::EXTERNAL
+	   )
+		return label_partition( partition, operationdetail ) && change_uuid( partition, operationdetail ) ;
+
+	if ( ! flush_partition_tables( operationdetail ) )
+		return false ;
+
+	if ( partition .get_label() .empty() && partition .uuid == UUID_RANDOM_NTFS_HALF )
+		operationdetail .add_child( OperationDetail( String::ucompose(
+				_("Clear partition label and set half of the UUID to a new, random value on %1"),
+				partition .get_path() ) ) ) ;
+	else if ( partition .get_label() .empty() )
+		operationdetail .add_child( OperationDetail( String::ucompose(
+				_("Clear partition label and set UUID to a new, random value on %1"),
+				partition .get_path() ) ) ) ;
+	else if ( partition .uuid == UUID_RANDOM_NTFS_HALF )
+		operationdetail .add_child( OperationDetail( String::ucompose(
+				_("Set partition label to \"%1\" and half of the UUID to a new, random value on %2"),
+				partition .get_label(), partition .get_path() ) ) ) ;
+	else
+		operationdetail .add_child( OperationDetail( String::ucompose(
+				_("Set partition label to \"%1\" and UUID to a new, random value on %2"),
+				partition .get_label(), partition .get_path() ) ) ) ;
+
+	note_filesystem_written( partition ) ;
+
+	FileSystem* p_filesystem = NULL ;
+	bool succes = ( p_filesystem = set_proper_filesystem( partition .filesystem ) ) &&
+	              p_filesystem ->write_label_and_uuid( partition, operationdetail .get_last_child() ) ;
+
+	operationdetail .get_last_child() .set_status( succes ? STATUS_SUCCES : STATUS_ERROR ) ;
+	return succes ;
+}
+
 bool GParted_Core::resize_move( const Device & device,
 				const Partition & partition_old,
 			  	Partition & partition_new,
@@ -2164,6 +2637,15 @@ bool GParted_Core::move_filesystem( const Partition & partition_old,
 		return true ;
 	}
 
+	if ( ! flush_partition_tables( operationdetail .get_last_child() ) )
+	{
+		operationdetail .get_last_child() .set_status( STATUS_ERROR ) ;
+		return false ;
+	}
+
+	note_filesystem_written( partition_old ) ;
+	note_filesystem_written( partition_new ) ;
+
 	bool succes = false ;
 	FileSystem* p_filesystem = NULL ;
 	switch ( get_fs( partition_old .filesystem ) .move )
@@ -2532,6 +3014,14 @@ bool GParted_Core::resize_filesystem( const Partition & partition_old,
 		}
 	}
 
+	if ( ! flush_partition_tables( operationdetail .get_last_child() ) )
+	{
+		operationdetail .get_last_child() .set_status( STATUS_ERROR ) ;
+		return false ;
+	}
+
+	note_filesystem_written( partition_new ) ;
+
 	bool succes = false ;
 	FileSystem* p_filesystem = NULL ;
 	switch ( action )
@@ -2548,11 +3038,17 @@ bool GParted_Core::resize_filesystem( const Partition & partition_old,
 			break ;
 #endif
 		case GParted::FS::EXTERNAL:
+		{
+			Glib::Timer timer ;
 			succes = ( p_filesystem = set_proper_filesystem( partition_new .filesystem ) ) &&
 				 p_filesystem ->resize( partition_new,
 							operationdetail .get_last_child(), 
 							fill_partition ) ;
+			if ( succes )
+				ThroughputModel::record_command( "resize", partition_new .filesystem,
+				                                 partition_new .get_byte_length(), timer .elapsed() ) ;
 			break ;
+		}
 
 		default:
 			break ;
@@ -2618,8 +3114,13 @@ bool GParted_Core::copy( const Partition & partition_src,
 			succes = create_partition( partition_dst, operationdetail, ( (min_size + (partition_dst .sector_size - 1)) / partition_dst .sector_size ) ) ;
 		}
 
-		if ( succes && set_partition_type( partition_dst, operationdetail ) )
+		if (   succes
+		    && set_partition_type( partition_dst, operationdetail )
+		    && flush_partition_tables( operationdetail )
+		   )
 		{
+			note_filesystem_written( partition_dst ) ;
+
 			operationdetail .add_child( OperationDetail( 
 				String::ucompose( _("copy file system of %1 to %2"),
 						  partition_src .get_path(),
@@ -2831,6 +3332,8 @@ void GParted_Core::rollback_transaction( const Partition & partition_src,
 	if ( total_done > 0 )
 	{
 		operationdetail .add_child( OperationDetail( _("roll back last transaction") ) ) ;
+		note_filesystem_written( partition_src ) ;
+		note_filesystem_written( partition_dst ) ;
 
 		//find out exactly which part of the file system was copied (and to where it was copied)..
 		Partition temp_src = partition_src ;
@@ -2856,11 +3359,25 @@ void GParted_Core::rollback_transaction( const Partition & partition_src,
 
 bool GParted_Core::check_repair_filesystem( const Partition & partition, OperationDetail & operationdetail ) 
 {
+	if ( ! flush_partition_tables( operationdetail ) )
+		return false ;
+
 	operationdetail .add_child( OperationDetail( 
 				String::ucompose(
 						/* TO TRANSLATORS: looks like   check file system on /dev/sda5 for errors and (if possible) fix them */
 						_("check file system on %1 for errors and (if possible) fix them"),
 						  partition .get_path() ) ) ) ;
+
+	if ( filesystem_known_clean( partition ) )
+	{
+		operationdetail .get_last_child() .add_child( OperationDetail(
+				_("the file system was found clean before and has not been written to since.  Hence skipping this check"),
+				STATUS_NONE,
+				FONT_ITALIC ) ) ;
+
+		operationdetail .get_last_child() .set_status( STATUS_SUCCES ) ;
+		return true ;
+	}
 	
 	bool succes = false ;
 	FileSystem* p_filesystem = NULL ;
@@ -2883,10 +3400,19 @@ bool GParted_Core::check_repair_filesystem( const Partition & partition, Operati
 			break ;
 #endif
 		case GParted::FS::EXTERNAL:
+		{
+			Glib::Timer timer ;
 			succes = ( p_filesystem = set_proper_filesystem( partition .filesystem ) ) &&
 				 p_filesystem ->check_repair( partition, operationdetail .get_last_child() ) ;
+			if ( succes )
+			{
+				ThroughputModel::record_command( "check", partition .filesystem,
+				                                 partition .get_byte_length(), timer .elapsed() ) ;
+				note_filesystem_clean( partition ) ;
+			}
 
 			break ;
+		}
 
 		default:
 			break ;
@@ -3044,19 +3570,29 @@ bool GParted_Core::copy_blocks( const Glib::ustring & src_device,
 			dst_start += ( ((length + (dst_sector_size - 1))/ dst_sector_size) - 1 ) ;
 		}
 
+		//The blocks are copied without the operations lock, while other threads
+		//  use libparted, so they are read and written through file descriptors
+		//  of this copy rather than through the PedDevices libparted shares
 		Glib::ustring error_message ;
-		buf = static_cast<char *>( malloc( llabs( blocksize ) ) ) ;
+		int fd_src = open( src_device .c_str(), O_RDONLY ) ;
+		int fd_dst = readonly ? -1 : open( dst_device .c_str(), O_WRONLY ) ;
+		char * buf = NULL ;
+		if ( fd_src >= 0 && ( readonly || fd_dst >= 0 ) )
+			buf = static_cast<char *>( malloc( llabs( blocksize ) ) ) ;
 		if ( buf )
 		{
 			ped_device_sync( lp_device_dst ) ;
 
 			succes = true ;
 			if ( done != 0 )
-				succes = copy_block( lp_device_src,
-						lp_device_dst,
+				succes = copy_block( fd_src,
+						fd_dst,
+						src_sector_size,
+						dst_sector_size,
 						src_start,
 						dst_start, 
 						done,
+						buf,
 						error_message,
 						readonly ) ;
 			if ( ! succes )
@@ -3065,18 +3601,30 @@ bool GParted_Core::copy_blocks( const Glib::ustring & src_device,
 			//add an empty sub which we will constantly update in the loop
 			operationdetail .get_last_child() .add_child( OperationDetail( "", STATUS_NONE ) ) ;
 
+			//The loop only uses the devices of this operation, so other operations
+			//  applied in parallel may go on meanwhile
+			bool released = Utils::release_operations_lock() ;
+
 			Glib::Timer timer_progress_timeout, timer_total ;
+			IOThrottle throttle ;
 			while( succes && llabs( done ) < length )
 			{
-				succes = copy_block( lp_device_src,
-						     lp_device_dst,
+				succes = copy_block( fd_src,
+						     fd_dst,
+						     src_sector_size,
+						     dst_sector_size,
 						     src_start + (done / src_sector_size),
 						     dst_start + (done / dst_sector_size),
 						     blocksize,
+						     buf,
 						     error_message,
 						     readonly ) ; 
 				if ( succes )
+				{
 					done += blocksize ;
+					//one read, and one write unless only reading
+					throttle .wait( llabs( blocksize ), readonly ? 1 : 2 ) ;
+				}
 
 				if ( timer_progress_timeout .elapsed() >= 0.5 )
 				{
@@ -3089,18 +3637,43 @@ bool GParted_Core::copy_blocks( const Glib::ustring & src_device,
 					timer_progress_timeout .reset() ;
 				}
 			}
+			if ( succes && ! readonly && fsync( fd_dst ) )
+			{
+				error_message = Glib::strerror( errno ) ;
+				succes = false ;
+			}
+			if ( released )
+				Utils::relock_operations() ;
+
+			//Remember the throughput for the estimates of later operations, unless it
+			//  was limited or too short to measure
+			Byte_Value limit_bytes ;
+			unsigned int limit_ios ;
+			IOThrottle::get_limits( limit_bytes, limit_ios ) ;
+			if ( succes && limit_bytes == 0 && limit_ios == 0 && timer_total .elapsed() >= 1 )
+			{
+				if ( readonly )
+					ThroughputModel::record_read( src_device, llabs( done ), timer_total .elapsed() ) ;
+				else
+					ThroughputModel::record_copy( dst_device, llabs( done ), timer_total .elapsed() ) ;
+			}
+
 			//set progress bar current info on completion
 			set_progress_info( length,
 			                   llabs( done ),
 			                   timer_total,
 			                   operationdetail .get_last_child() .get_last_child(),
 			                   readonly ) ;
-			
-			free( buf ) ;
 		}
 		else
 			error_message = Glib::strerror( errno ) ;
 
+		free( buf ) ;
+		if ( fd_src >= 0 )
+			close( fd_src ) ;
+		if ( fd_dst >= 0 )
+			close( fd_dst ) ;
+
 		//reset fraction to -1 to make room for a new one (or a pulsebar)
 		operationdetail .get_last_child() .get_last_child() .fraction = -1 ;
 
@@ -3121,14 +3694,17 @@ bool GParted_Core::copy_blocks( const Glib::ustring & src_device,
 		
 		total_done += llabs( done ) ;
 	
-		//close and destroy the devices..
+		//close and destroy the devices, except those a partition table session
+		//  holds, as ped_device_get() hands out the session's own PedDevice
 		ped_device_close( lp_device_src ) ;
-		ped_device_destroy( lp_device_src ) ; 
+		if ( ! device_in_table_session( lp_device_src ) )
+			ped_device_destroy( lp_device_src ) ;
 
 		if ( src_device != dst_device )
 		{
 			ped_device_close( lp_device_dst ) ;
-			ped_device_destroy( lp_device_dst ) ;
+			if ( ! device_in_table_session( lp_device_dst ) )
+				ped_device_destroy( lp_device_dst ) ;
 		}
 	}
 
@@ -3136,17 +3712,17 @@ bool GParted_Core::copy_blocks( const Glib::ustring & src_device,
 	return succes ;
 }
 
-bool GParted_Core::copy_block( PedDevice * lp_device_src,
-			       PedDevice * lp_device_dst,
+bool GParted_Core::copy_block( int fd_src,
+			       int fd_dst,
+			       Byte_Value sector_size_src,
+			       Byte_Value sector_size_dst,
 			       Sector offset_src,
 			       Sector offset_dst,
 			       Byte_Value block_length,
+			       char * buf,
 			       Glib::ustring & error_message,
 			       bool readonly ) 
 {
-	Byte_Value sector_size_src = lp_device_src ->sector_size ;
-	Byte_Value sector_size_dst = lp_device_dst ->sector_size ;
-
 	//Handle case where src and dst sector sizes are different.
 	//    E.g.,  5 sectors x 512 bytes/sector = ??? 2048 byte sectors
 	Sector num_blocks_src = (llabs(block_length) + (sector_size_src - 1) ) / sector_size_src ;
@@ -3164,9 +3740,10 @@ bool GParted_Core::copy_block( PedDevice * lp_device_src,
 
 	if ( block_length != 0 )
 	{
-		if ( ped_device_read( lp_device_src, buf, offset_src, num_blocks_src ) )
+		if ( transfer_all( fd_src, buf, num_blocks_src * sector_size_src, offset_src * sector_size_src, false ) )
 		{
-			if ( readonly || ped_device_write( lp_device_dst, buf, offset_dst, num_blocks_dst ) )
+			if ( readonly ||
+			     transfer_all( fd_dst, buf, num_blocks_dst * sector_size_dst, offset_dst * sector_size_dst, true ) )
 				return true ;
 			else
 				error_message = String::ucompose( _("Error while writing block at sector %1"), offset_dst ) ;
@@ -3178,6 +3755,26 @@ bool GParted_Core::copy_block( PedDevice * lp_device_src,
 	return false ;
 }
 
+//Read or write count bytes at offset, as pread() and pwrite() may transfer less
+//  than asked
+bool GParted_Core::transfer_all( int fd, char * buf, Byte_Value count, Byte_Value offset, bool write )
+{
+	while ( count > 0 )
+	{
+		ssize_t done = write ? pwrite64( fd, buf, count, offset ) : pread64( fd, buf, count, offset ) ;
+		if ( done < 0 && errno == EINTR )
+			continue ;
+		if ( done <= 0 )
+			return false ;
+
+		buf += done ;
+		count -= done ;
+		offset += done ;
+	}
+
+	return true ;
+}
+
 bool GParted_Core::calibrate_partition( Partition & partition, OperationDetail & operationdetail ) 
 {
 	if ( partition .type == TYPE_PRIMARY || partition .type == TYPE_LOGICAL || partition .type == TYPE_EXTENDED )
@@ -3320,12 +3917,43 @@ FileSystem* GParted_Core::set_proper_filesystem( const FILESYSTEM & filesystem )
 	return get_filesystem_object( filesystem ) ;
 }
 
+//The object for the file system in the session of the calling thread.  Sessions
+//  don't share them as they keep the output of their last command.
 FileSystem * GParted_Core::get_filesystem_object( const FILESYSTEM & filesystem )
 {
-	if ( FILESYSTEM_MAP .count( filesystem ) )
-	    return FILESYSTEM_MAP[ filesystem ] ;
-	else
-	    return NULL ;
+	std::map< FILESYSTEM, FileSystem * > & filesystems = CoreSession::get() .filesystems ;
+	std::map< FILESYSTEM, FileSystem * >::iterator iter = filesystems .find( filesystem ) ;
+	if ( iter == filesystems .end() )
+		iter = filesystems .insert( std::make_pair( filesystem, new_filesystem_object( filesystem ) ) ) .first ;
+
+	return iter ->second ;
+}
+
+FileSystem * GParted_Core::new_filesystem_object( FILESYSTEM filesystem )
+{
+	switch ( filesystem )
+	{
+		case FS_BTRFS		: return new btrfs() ;
+		case FS_EXFAT		: return new exfat() ;
+		case FS_EXT2		: return new ext2() ;
+		case FS_EXT3		: return new ext3() ;
+		case FS_EXT4		: return new ext4() ;
+		case FS_FAT16		: return new fat16() ;
+		case FS_FAT32		: return new fat32() ;
+		case FS_HFS		: return new hfs() ;
+		case FS_HFSPLUS		: return new hfsplus() ;
+		case FS_JFS		: return new jfs() ;
+		case FS_LINUX_SWAP	: return new linux_swap() ;
+		case FS_LVM2_PV		: return new lvm2_pv() ;
+		case FS_NILFS2		: return new nilfs2() ;
+		case FS_NTFS		: return new ntfs() ;
+		case FS_REISER4		: return new reiser4() ;
+		case FS_REISERFS	: return new reiserfs() ;
+		case FS_UFS		: return new ufs() ;
+		case FS_XFS		: return new xfs() ;
+		case FS_LUKS		: return new luks() ;
+		default			: return NULL ;
+	}
 }
 
 bool GParted_Core::filesystem_resize_disallowed( const Partition & partition )
@@ -3345,6 +3973,8 @@ bool GParted_Core::filesystem_resize_disallowed( const Partition & partition )
 #ifndef HAVE_LIBPARTED_3_0_0_PLUS
 bool GParted_Core::erase_filesystem_signatures( const Partition & partition ) 
 {
+	note_filesystem_written( partition ) ;
+
 	bool return_value = false ;
 
 	PedDevice* lp_device = NULL ;
@@ -3379,6 +4009,10 @@ bool GParted_Core::update_bootsector( const Partition & partition, OperationDeta
 	//FIXME: this should probably be done in the fs classes...
 	if ( partition .filesystem == FS_NTFS )
 	{
+		if ( ! flush_partition_tables( operationdetail ) )
+			return false ;
+		note_filesystem_written( partition ) ;
+
 		//The NTFS file system stores a value in the boot record called the
 		//  Number of Hidden Sectors.  This value must match the partition start
 		//  sector number in order for Windows to boot from the file system.
@@ -3469,10 +4103,42 @@ PedDevice* GParted_Core::open_device( const Glib::ustring & device_path )
 bool GParted_Core::open_device_and_disk( const Glib::ustring & device_path,
                                          PedDevice*& lp_device, PedDisk*& lp_disk, bool strict )
 {
+	//While applying operations hand out the disk already held for this device so
+	//  that partition table changes accumulate in memory.  See commit().  A session
+	//  left by the previous operation on the disk is taken over.
+	bool sessions_enabled = CoreSession::get() .table_session ;
+	std::map< Glib::ustring, TableSession >::iterator iter = table_sessions .find( device_path ) ;
+	if ( iter != table_sessions .end() && sessions_enabled &&
+	     ( iter ->second .owner == Glib::Thread::self() || ! iter ->second .owner ) )
+	{
+		iter ->second .owner = Glib::Thread::self() ;
+		lp_device = iter ->second .lp_device ;
+		lp_disk = iter ->second .lp_disk ;
+		return true ;
+	}
+
 	lp_device = open_device( device_path ) ;
 	if ( lp_device )
 	{
 		lp_disk = ped_disk_new( lp_device );
+
+		if ( lp_disk && sessions_enabled && iter == table_sessions .end() )
+		{
+#ifndef USE_LIBPARTED_DMRAID
+			//dmraid partitions are dev mapper entries created from the on disk
+			//  partition table, so changes to it can't be held back
+			DMRaid dmraid ;
+			if ( ! dmraid .is_dmraid_device( device_path ) )
+#endif
+			{
+				TableSession session ;
+				session .lp_device = lp_device ;
+				session .lp_disk = lp_disk ;
+				session .dirty = false ;
+				session .owner = Glib::Thread::self() ;
+				table_sessions[ device_path ] = session ;
+			}
+		}
 	
 		//if ! disk and writeable it's probably a HD without disklabel.
 		//We return true here and deal with them in GParted_Core::get_devices
@@ -3495,9 +4161,19 @@ void GParted_Core::close_disk( PedDisk*& lp_disk )
 
 void GParted_Core::close_device_and_disk( PedDevice*& lp_device, PedDisk*& lp_disk )
 {
+	//Disks held by a partition table session are released by close_partition_tables()
+	if ( get_table_session( lp_disk ) )
+	{
+		lp_device = NULL ;
+		lp_disk = NULL ;
+		return ;
+	}
+
 	close_disk( lp_disk ) ;
 
-	if ( lp_device )
+	//the device of a disk held by a session is the one ped_device_get() returns
+	//  for its path, so it is also kept when opened without the session
+	if ( lp_device && ! device_in_table_session( lp_device ) )
 		ped_device_destroy( lp_device ) ;
 		
 	lp_device = NULL ;
@@ -3505,6 +4181,15 @@ void GParted_Core::close_device_and_disk( PedDevice*& lp_device, PedDisk*& lp_di
 
 bool GParted_Core::commit( PedDisk* lp_disk )
 {
+	//Changes to a disk held by a partition table session are written out later
+	//  by flush_partition_tables()
+	TableSession * session = get_table_session( lp_disk ) ;
+	if ( session )
+	{
+		session ->dirty = true ;
+		return true ;
+	}
+
 	bool succes = ped_disk_commit_to_dev( lp_disk ) ;
 	
 	succes = commit_to_os( lp_disk, 10 ) && succes ;
@@ -3512,6 +4197,177 @@ bool GParted_Core::commit( PedDisk* lp_disk )
 	return succes ;
 }
 
+GParted_Core::TableSession * GParted_Core::get_table_session( PedDisk* lp_disk )
+{
+	if ( ! lp_disk )
+		return NULL ;
+
+	for ( std::map< Glib::ustring, TableSession >::iterator iter = table_sessions .begin() ;
+	      iter != table_sessions .end() ;
+	      ++iter )
+		if ( iter ->second .lp_disk == lp_disk )
+			return & iter ->second ;
+
+	return NULL ;
+}
+
+bool GParted_Core::device_in_table_session( PedDevice* lp_device )
+{
+	for ( std::map< Glib::ustring, TableSession >::const_iterator iter = table_sessions .begin() ;
+	      iter != table_sessions .end() ;
+	      ++iter )
+		if ( iter ->second .lp_device == lp_device )
+			return true ;
+
+	return false ;
+}
+
+//Write out the changes held for one disk
+bool GParted_Core::commit_table_session( const Glib::ustring & device_path,
+                                         TableSession & session,
+                                         OperationDetail & operationdetail )
+{
+	operationdetail .add_child( OperationDetail(
+			String::ucompose( _("commit partition table changes on %1"), device_path ) ) ) ;
+
+	bool committed = ped_disk_commit_to_dev( session .lp_disk ) ;
+	committed = commit_to_os( session .lp_disk, 10 ) && committed ;
+	session .dirty = false ;
+
+	operationdetail .get_last_child() .set_status( committed ? STATUS_SUCCES : STATUS_ERROR ) ;
+	return committed ;
+}
+
+//Write out the changes held for the disks of the calling thread's operation
+bool GParted_Core::flush_partition_tables( OperationDetail & operationdetail )
+{
+	bool succes = true ;
+	for ( std::map< Glib::ustring, TableSession >::iterator iter = table_sessions .begin() ;
+	      iter != table_sessions .end() ;
+	      ++iter )
+		if ( iter ->second .dirty && iter ->second .owner == Glib::Thread::self() )
+			succes = commit_table_session( iter ->first, iter ->second, operationdetail ) && succes ;
+
+	return succes ;
+}
+
+bool GParted_Core::close_partition_tables( OperationDetail & operationdetail )
+{
+	bool succes = flush_partition_tables( operationdetail ) ;
+
+	std::map< Glib::ustring, TableSession >::iterator iter = table_sessions .begin() ;
+	while ( iter != table_sessions .end() )
+	{
+		if ( iter ->second .owner == Glib::Thread::self() )
+		{
+			//no longer a session, so close_device_and_disk() releases it
+			TableSession session = iter ->second ;
+			table_sessions .erase( iter++ ) ;
+			close_device_and_disk( session .lp_device, session .lp_disk ) ;
+		}
+		else
+			++iter ;
+	}
+
+	return succes ;
+}
+
+//Write out and close the partition tables still held once applying the
+//  operations is over, which happens when it was cancelled or an operation failed
+//  while others were applied.  The operations applied so far rely on the changes
+//  handed on by them, so those are committed, as without sessions, and reported in
+//  the details of the last of the given operations on the disk.  A table still
+//  owned by a thread was left part way through a step when that thread was
+//  cancelled, so it is closed without writing it.
+bool GParted_Core::close_held_partition_tables( const std::vector<Operation *> & operations )
+{
+	if ( ! Utils::lock_operations() )
+		return false ;
+
+	bool succes = true ;
+	std::map< Glib::ustring, TableSession >::iterator iter = table_sessions .begin() ;
+	while ( iter != table_sessions .end() )
+	{
+		Glib::ustring device_path = iter ->first ;
+		TableSession session = iter ->second ;
+		table_sessions .erase( iter++ ) ;
+
+		Operation * operation = operations .empty() ? NULL : operations .back() ;
+		for ( unsigned int t = 0 ; t < operations .size() ; t++ )
+			if ( operations[ t ] ->device .get_path() == device_path )
+				operation = operations[ t ] ;
+
+		OperationDetail operationdetail ;
+		if ( session .dirty && session .owner )
+		{
+			( operation ? operation ->operation_detail : operationdetail ) .add_child( OperationDetail(
+				String::ucompose( _("partition table changes on %1 were not written, as the operation was cancelled"),
+				                  device_path ),
+				STATUS_INFO ) ) ;
+		}
+		else if ( session .dirty )
+		{
+			if ( ! commit_table_session( device_path,
+			                             session,
+			                             operation ? operation ->operation_detail : operationdetail ) )
+			{
+				if ( operation )
+					operation ->operation_detail .set_status( STATUS_ERROR ) ;
+				succes = false ;
+			}
+		}
+
+		//no longer a session, so close_device_and_disk() releases it
+		close_device_and_disk( session .lp_device, session .lp_disk ) ;
+	}
+
+	Utils::unlock_operations() ;
+	return succes ;
+}
+
+//Keep the disks of the calling thread's operation open for the next operation on
+//  them, which may be applied by another thread
+void GParted_Core::release_partition_tables()
+{
+	for ( std::map< Glib::ustring, TableSession >::iterator iter = table_sessions .begin() ;
+	      iter != table_sessions .end() ;
+	      ++iter )
+		if ( iter ->second .owner == Glib::Thread::self() )
+			iter ->second .owner = NULL ;
+}
+
+//A clean check of a file system is reused until something writes to it.  The write
+//  generation is kept by the start of the file system, as moving or resizing the
+//  partition keeps the start of the file system it writes to.  Only used by the
+//  thread holding the operations lock.
+void GParted_Core::note_filesystem_written( const Partition & partition )
+{
+	write_generations[ partition .device_path + "@" + Utils::num_to_str( partition .sector_start ) ] =
+		++last_write_generation ;
+}
+
+void GParted_Core::note_filesystem_clean( const Partition & partition )
+{
+	std::map< Glib::ustring, unsigned long >::const_iterator iter =
+		write_generations .find( partition .device_path + "@" + Utils::num_to_str( partition .sector_start ) ) ;
+	clean_checks[ partition .device_path + "@" + Utils::num_to_str( partition .sector_start ) +
+	              "-" + Utils::num_to_str( partition .sector_end ) ] =
+		iter == write_generations .end() ? 0 : iter ->second ;
+}
+
+bool GParted_Core::filesystem_known_clean( const Partition & partition )
+{
+	std::map< Glib::ustring, unsigned long >::const_iterator check =
+		clean_checks .find( partition .device_path + "@" + Utils::num_to_str( partition .sector_start ) +
+		                    "-" + Utils::num_to_str( partition .sector_end ) ) ;
+	if ( check == clean_checks .end() )
+		return false ;
+
+	std::map< Glib::ustring, unsigned long >::const_iterator iter =
+		write_generations .find( partition .device_path + "@" + Utils::num_to_str( partition .sector_start ) ) ;
+	return check ->second == ( iter == write_generations .end() ? 0 : iter ->second ) ;
+}
+
 bool GParted_Core::commit_to_os( PedDisk* lp_disk, std::time_t timeout )
 {
 	bool succes ;
@@ -3591,6 +4447,8 @@ public:
 
 PedExceptionOption GParted_Core::ped_exception_handler( PedException * e ) 
 {
+	std::vector<Glib::ustring> & libparted_messages = get_libparted_messages() ;
+
 	PedExceptionOption ret = PED_EXCEPTION_UNHANDLED;
         std::cout << e ->message << std::endl ;
 
@@ -18,6 +18,7 @@
 #include "../include/HBoxOperations.h" 
  
 #include <gtkmm/stock.h>
+#include <set>
 
 namespace GParted
 {
@@ -30,6 +31,8 @@ HBoxOperations::HBoxOperations()
 	treeview_operations .set_headers_visible( false );
 	treeview_operations .append_column( "", treeview_operations_columns .operation_icon );
 	treeview_operations .append_column( "", treeview_operations_columns .operation_description );
+	treeview_operations .append_column( "", treeview_operations_columns .operation_duration );
+	treeview_operations .get_column( 1 ) ->set_expand( true ) ;
 	treeview_operations .get_selection() ->set_mode( Gtk::SELECTION_NONE ) ;
 	treeview_operations .signal_button_press_event() .connect( 
 		sigc::mem_fun( *this, &HBoxOperations::on_signal_button_press_event ), false ) ;
@@ -61,20 +64,63 @@ HBoxOperations::HBoxOperations()
 		Gtk::Stock::CLOSE, sigc::mem_fun(*this, &HBoxOperations::on_close) ) );
 }
 
-void HBoxOperations::load_operations( const std::vector<Operation *> operations ) 
+//Update the list to show the operations with their estimated durations in
+//  seconds, only touching the rows of operations which were added or changed
+void HBoxOperations::load_operations( const std::vector<Operation *> & operations,
+                                      const std::vector<double> & durations ) 
 {
-	liststore_operations ->clear();
+	//The rows are in the order of the operations they show, so walk them together,
+	//  matching rows to operations by identity
+	std::set<Operation *> queued( operations .begin(), operations .end() ) ;
+	Gtk::TreeModel::Children rows = liststore_operations ->children() ;
+	Gtk::TreeModel::iterator iter = rows .begin() ;
+	bool added = false ;
 
 	Gtk::TreeRow treerow ;
 	for ( unsigned int t = 0 ; t < operations .size(); t++ )
 	{	
-		treerow = *( liststore_operations ->append() );
+		/*TO TRANSLATORS: looks like  about 00:12:30 */
+		Glib::ustring duration = String::ucompose( _("about %1"),
+		                                           Utils::format_time( Utils::round( durations[ t ] ) ) ) ;
+
+		//remove the rows of operations which are no longer queued
+		while ( iter != rows .end() &&
+		        ! queued .count( static_cast<Operation *>( ( *iter )[ treeview_operations_columns .operation ] ) ) )
+			iter = liststore_operations ->erase( iter ) ;
+
+		if ( iter != rows .end() &&
+		     static_cast<Operation *>( ( *iter )[ treeview_operations_columns .operation ] ) == operations[ t ] )
+		{
+			treerow = *iter ;
+			++iter ;
+
+			if (    static_cast<Glib::ustring>( treerow[ treeview_operations_columns .operation_description ] )
+			            == operations[ t ] ->description
+			     && static_cast< Glib::RefPtr<Gdk::Pixbuf> >( treerow[ treeview_operations_columns .operation_icon ] )
+			            == operations[ t ] ->icon
+			     && static_cast<Glib::ustring>( treerow[ treeview_operations_columns .operation_duration ] )
+			            == duration
+			   )
+				continue ;
+		}
+		else
+		{
+			treerow = *( liststore_operations ->insert( iter ) );
+			treerow[ treeview_operations_columns .operation ] = operations[ t ] ;
+			added = true ;
+		}
+
 		treerow[ treeview_operations_columns .operation_description ] = operations[ t ] ->description ;
 		treerow[ treeview_operations_columns .operation_icon ] = operations[ t ] ->icon ;
+		treerow[ treeview_operations_columns .operation_duration ] = duration ;
 	}
+
+	//remove the rows of operations which no longer exist, or moved in the queue
+	while ( iter != rows .end() )
+		iter = liststore_operations ->erase( iter ) ;
 		
-	//make scrollwindow focus on the last operation in the list	
-	if ( liststore_operations ->children() .size() > 0 )
+	//make scrollwindow focus on the last operation in the list when one was added
+	if ( added )
 		treeview_operations .set_cursor( static_cast<Gtk::TreePath>( static_cast<Gtk::TreeRow>( 
 					*(--liststore_operations ->children() .end()) ) ) ) ;
 }
@@ -0,0 +1,236 @@
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#include "../include/IOThrottle.h"
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstdlib>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace GParted
+{
+
+//I/O scheduling classes, see ioprio_set(2)
+static const int IO_CLASS_NONE = 0 ;
+static const int IO_CLASS_BEST_EFFORT = 2 ;
+static const int IO_CLASS_IDLE = 3 ;
+static const int IO_WHO_PROCESS = 1 ;
+static const int IO_CLASS_SHIFT = 13 ;
+
+static const char * CGROUP_ROOT = "/sys/fs/cgroup" ;
+
+//Initialize static data elements
+Glib::Mutex IOThrottle::mutex ;
+Byte_Value IOThrottle::bytes_per_second = 0 ;
+unsigned int IOThrottle::ios_per_second = 0 ;
+int IOThrottle::priority_class = IO_CLASS_NONE ;
+int IOThrottle::priority_level = 0 ;
+std::map<pid_t, IOThrottle::Group> IOThrottle::groups ;
+unsigned int IOThrottle::group_count = 0 ;
+
+IOThrottle::IOThrottle()
+{
+	byte_tokens = 0 ;
+	io_tokens = 0 ;
+	timer .start() ;
+}
+
+//Account for a transfer of bytes done in ios I/O requests, sleeping as long as
+//  this takes the copy over the limits.  The bucket holds at most one second's
+//  worth of tokens, so an idle period doesn't allow a long burst afterwards.
+void IOThrottle::wait( Byte_Value bytes, unsigned int ios )
+{
+	byte_tokens -= bytes ;
+	io_tokens -= ios ;
+	while ( true )
+	{
+		Byte_Value byte_rate ;
+		unsigned int io_rate ;
+		get_limits( byte_rate, io_rate ) ;
+
+		double elapsed = timer .elapsed() ;
+		timer .reset() ;
+		byte_tokens = byte_rate > 0 ? std::min( byte_tokens + elapsed * byte_rate, double( byte_rate ) ) : 0 ;
+		io_tokens = io_rate > 0 ? std::min( io_tokens + elapsed * io_rate, double( io_rate ) ) : 0 ;
+
+		double delay = 0 ;
+		if ( byte_tokens < 0 )
+			delay = -byte_tokens / byte_rate ;
+		if ( io_tokens < 0 )
+			delay = std::max( delay, -io_tokens / io_rate ) ;
+		if ( delay <= 0 )
+			return ;
+
+		//sleep in short steps so that a changed limit applies straight away
+		Glib::usleep( static_cast<unsigned long>( std::min( delay, 0.1 ) * 1000000 ) ) ;
+	}
+}
+
+//Set the I/O scheduling class for the operations from "idle", "best-effort",
+//  "best-effort:LEVEL" with LEVEL from 0 (highest) to 7, or "none".
+bool IOThrottle::set_priority( const Glib::ustring & priority )
+{
+	int new_class ;
+	int new_level = 0 ;
+	if ( priority == "none" )
+		new_class = IO_CLASS_NONE ;
+	else if ( priority == "idle" )
+		new_class = IO_CLASS_IDLE ;
+	else if ( priority == "best-effort" )
+	{
+		new_class = IO_CLASS_BEST_EFFORT ;
+		new_level = 4 ;
+	}
+	else if ( priority .substr( 0, 12 ) == "best-effort:" &&
+	          priority .size() == 13 && priority[ 12 ] >= '0' && priority[ 12 ] <= '7' )
+	{
+		new_class = IO_CLASS_BEST_EFFORT ;
+		new_level = priority[ 12 ] - '0' ;
+	}
+	else
+		return false ;
+
+	Glib::Mutex::Lock lock( mutex ) ;
+	priority_class = new_class ;
+	priority_level = new_level ;
+	return true ;
+}
+
+//Change the limits, also for the operations already running.  Zero means no limit.
+void IOThrottle::set_limits( Byte_Value new_bytes_per_second, unsigned int new_ios_per_second )
+{
+	Glib::Mutex::Lock lock( mutex ) ;
+	bytes_per_second = std::max( new_bytes_per_second, Byte_Value( 0 ) ) ;
+	ios_per_second = new_ios_per_second ;
+
+	for ( std::map<pid_t, Group>::const_iterator iter = groups .begin() ; iter != groups .end() ; ++iter )
+		write_io_max( iter ->second ) ;
+}
+
+void IOThrottle::get_limits( Byte_Value & current_bytes_per_second, unsigned int & current_ios_per_second )
+{
+	Glib::Mutex::Lock lock( mutex ) ;
+	current_bytes_per_second = bytes_per_second ;
+	current_ios_per_second = ios_per_second ;
+}
+
+//Called by the thread which is about to apply an operation to the given disks
+void IOThrottle::begin_operation( const std::vector<Glib::ustring> & device_paths )
+{
+	Glib::Mutex::Lock lock( mutex ) ;
+	set_thread_priority( priority_class, priority_level ) ;
+
+	//Only use a cgroup when the io controller is already enabled for the children
+	//  of the root, rather than changing how the whole system is set up.
+	std::ifstream subtree_control( ( Glib::ustring( CGROUP_ROOT ) + "/cgroup.subtree_control" ) .c_str() ) ;
+	std::string controller ;
+	bool io_available = false ;
+	while ( subtree_control >> controller && ! io_available )
+		io_available = controller == "io" ;
+	if ( ! io_available )
+		return ;
+
+	Group group ;
+	for ( unsigned int t = 0 ; t < device_paths .size() ; t++ )
+	{
+		struct stat st ;
+		if ( stat( device_paths[ t ] .c_str(), &st ) == 0 && S_ISBLK( st .st_mode ) )
+		{
+			Glib::ustring device = Utils::num_to_str( major( st .st_rdev ) ) + ":" +
+			                       Utils::num_to_str( minor( st .st_rdev ) ) ;
+			if ( std::find( group .devices .begin(), group .devices .end(), device ) == group .devices .end() )
+				group .devices .push_back( device ) ;
+		}
+	}
+	if ( group .devices .empty() )
+		return ;
+
+	group .path = Glib::ustring( CGROUP_ROOT ) + "/gparted-" + Utils::num_to_str( getpid() ) +
+	              "-" + Utils::num_to_str( ++group_count ) ;
+	if ( mkdir( group .path .c_str(), 0755 ) != 0 )
+		return ;
+	if ( ! write_io_max( group ) )
+	{
+		rmdir( group .path .c_str() ) ;
+		return ;
+	}
+
+	groups[ get_thread_id() ] = group ;
+}
+
+void IOThrottle::end_operation()
+{
+	Glib::Mutex::Lock lock( mutex ) ;
+	set_thread_priority( IO_CLASS_NONE, 0 ) ;
+
+	std::map<pid_t, Group>::iterator iter = groups .find( get_thread_id() ) ;
+	if ( iter != groups .end() )
+	{
+		//fails when a command left a process behind, which then keeps its limits
+		rmdir( iter ->second .path .c_str() ) ;
+		groups .erase( iter ) ;
+	}
+}
+
+//Shell code to put in front of a command run for the operation of the calling
+//  thread, which moves the shell into the cgroup of the operation.
+Glib::ustring IOThrottle::get_command_prefix()
+{
+	Glib::Mutex::Lock lock( mutex ) ;
+	std::map<pid_t, Group>::const_iterator iter = groups .find( get_thread_id() ) ;
+	if ( iter == groups .end() )
+		return "" ;
+
+	return "echo $$ > " + iter ->second .path + "/cgroup.procs 2> /dev/null ; " ;
+}
+
+//Private Methods
+pid_t IOThrottle::get_thread_id()
+{
+	return syscall( SYS_gettid ) ;
+}
+
+//Set the I/O scheduling class of the calling thread.  Commands started from the
+//  thread inherit it.
+void IOThrottle::set_thread_priority( int new_class, int new_level )
+{
+#ifdef SYS_ioprio_set
+	syscall( SYS_ioprio_set, IO_WHO_PROCESS, get_thread_id(), ( new_class << IO_CLASS_SHIFT ) | new_level ) ;
+#endif
+}
+
+bool IOThrottle::write_io_max( const Group & group )
+{
+	Glib::ustring bytes = bytes_per_second > 0 ? Utils::num_to_str( bytes_per_second ) : "max" ;
+	Glib::ustring ios = ios_per_second > 0 ? Utils::num_to_str( ios_per_second ) : "max" ;
+
+	bool success = true ;
+	for ( unsigned int t = 0 ; t < group .devices .size() ; t++ )
+	{
+		//the kernel takes one device per write
+		std::ofstream io_max( ( group .path + "/io.max" ) .c_str() ) ;
+		io_max << group .devices[ t ] << " rbps=" << bytes << " wbps=" << bytes
+		       << " riops=" << ios << " wiops=" << ios << std::flush ;
+		success = success && io_max .good() ;
+	}
+	return success ;
+}
+
+}//GParted
@@ -76,9 +76,14 @@ enum LV_BIT
 //                         "Test-VG4,wzx-n-,,"
 //                        ]
 //  error_messages      - String vector storing whole cache error messages.
+//
+//  mutex               - Guards all of the above.  It is never held while an lvm
+//                        command runs, so the public methods lock it only after
+//                        initialize_if_required().
 
 
 //Initialize static data elements
+Glib::Mutex LVM2_PV_Info::mutex ;
 bool LVM2_PV_Info::lvm2_pv_info_cache_initialized = false ;
 bool LVM2_PV_Info::lvm_found = false ;
 std::vector<Glib::ustring> LVM2_PV_Info::lvm2_pv_cache ;
@@ -92,11 +97,7 @@ LVM2_PV_Info::LVM2_PV_Info()
 LVM2_PV_Info::LVM2_PV_Info( bool do_refresh )
 {
 	if ( do_refresh )
-	{
-		set_command_found() ;
-		load_lvm2_pv_info_cache() ;
-		lvm2_pv_info_cache_initialized = true ;
-	}
+		load_lvm2_pv_info_cache( set_command_found() ) ;
 }
 
 LVM2_PV_Info::~LVM2_PV_Info()
@@ -105,13 +106,13 @@ LVM2_PV_Info::~LVM2_PV_Info()
 
 bool LVM2_PV_Info::is_lvm2_pv_supported()
 {
-	set_command_found() ;
-	return ( lvm_found ) ;
+	return set_command_found() ;
 }
 
 Glib::ustring LVM2_PV_Info::get_vg_name( const Glib::ustring & path )
 {
 	initialize_if_required() ;
+	Glib::Mutex::Lock lock( mutex ) ;
 	return get_pv_attr_by_path( path, PVATTR_VG_NAME ) ;
 }
 
@@ -119,6 +120,7 @@ Glib::ustring LVM2_PV_Info::get_vg_name( const Glib::ustring & path )
 Byte_Value LVM2_PV_Info::get_size_bytes( const Glib::ustring & path )
 {
 	initialize_if_required() ;
+	Glib::Mutex::Lock lock( mutex ) ;
 	Glib::ustring str = get_pv_attr_by_path( path, PVATTR_PV_SIZE ) ;
 	return lvm2_pv_attr_to_num( str ) ;
 }
@@ -127,6 +129,7 @@ Byte_Value LVM2_PV_Info::get_size_bytes( const Glib::ustring & path )
 Byte_Value LVM2_PV_Info::get_free_bytes( const Glib::ustring & path )
 {
 	initialize_if_required() ;
+	Glib::Mutex::Lock lock( mutex ) ;
 	Glib::ustring str = get_pv_attr_by_path( path, PVATTR_PV_FREE ) ;
 	return lvm2_pv_attr_to_num( str ) ;
 }
@@ -135,6 +138,7 @@ Byte_Value LVM2_PV_Info::get_free_bytes( const Glib::ustring & path )
 bool LVM2_PV_Info::has_active_lvs( const Glib::ustring & path )
 {
 	initialize_if_required() ;
+	Glib::Mutex::Lock lock( mutex ) ;
 	Glib::ustring vgname = get_pv_attr_by_path( path, PVATTR_VG_NAME ) ;
 	if ( vgname == "" )
 		//PV not yet included in any VG
@@ -156,6 +160,7 @@ bool LVM2_PV_Info::has_active_lvs( const Glib::ustring & path )
 bool LVM2_PV_Info::is_vg_exported( const Glib::ustring & vgname )
 {
 	initialize_if_required() ;
+	Glib::Mutex::Lock lock( mutex ) ;
 
 	return bit_set( get_vg_attr_by_name( vgname, VGATTR_VG_BITS ), VGBIT_EXPORTED ) ;
 }
@@ -164,6 +169,7 @@ bool LVM2_PV_Info::is_vg_exported( const Glib::ustring & vgname )
 std::vector<Glib::ustring> LVM2_PV_Info::get_vg_members( const Glib::ustring & vgname )
 {
 	initialize_if_required() ;
+	Glib::Mutex::Lock lock( mutex ) ;
 	std::vector<Glib::ustring> members ;
 
 	for ( unsigned int i = 0 ; i < lvm2_pv_cache .size() ; i ++ )
@@ -180,6 +186,7 @@ std::vector<Glib::ustring> LVM2_PV_Info::get_vg_members( const Glib::ustring & v
 std::vector<Glib::ustring> LVM2_PV_Info::get_error_messages( const Glib::ustring & path )
 {
 	initialize_if_required() ;
+	Glib::Mutex::Lock lock( mutex ) ;
 	if ( ! error_messages .empty() )
 		//Return whole cache error messages as first choice
 		return error_messages ;
@@ -203,29 +210,36 @@ std::vector<Glib::ustring> LVM2_PV_Info::get_error_messages( const Glib::ustring
 
 void LVM2_PV_Info::initialize_if_required()
 {
-	if ( ! lvm2_pv_info_cache_initialized )
 	{
-		set_command_found() ;
-		load_lvm2_pv_info_cache() ;
-		lvm2_pv_info_cache_initialized = true ;
+		Glib::Mutex::Lock lock( mutex ) ;
+		if ( lvm2_pv_info_cache_initialized )
+			return ;
 	}
+
+	load_lvm2_pv_info_cache( set_command_found() ) ;
 }
 
-void LVM2_PV_Info::set_command_found()
+//Set status of command found.  Returns whether it was found.
+bool LVM2_PV_Info::set_command_found()
 {
-	//Set status of command found
-	lvm_found = ( ! Glib::find_program_in_path( "lvm" ) .empty() ) ;
+	bool found = ( ! Glib::find_program_in_path( "lvm" ) .empty() ) ;
+
+	Glib::Mutex::Lock lock( mutex ) ;
+	lvm_found = found ;
+	return found ;
 }
 
-void LVM2_PV_Info::load_lvm2_pv_info_cache()
+//The lvm commands run without holding the lock.  The new results then replace
+//  the cache at once.
+void LVM2_PV_Info::load_lvm2_pv_info_cache( bool lvm_available )
 {
 	Glib::ustring output, error ;
 	unsigned int i ;
 
-	lvm2_pv_cache .clear() ;
-	lvm2_vg_cache .clear() ;
-	error_messages .clear() ;
-	if ( lvm_found )
+	std::vector<Glib::ustring> new_lvm2_pv_cache ;
+	std::vector<Glib::ustring> new_lvm2_vg_cache ;
+	std::vector<Glib::ustring> new_error_messages ;
+	if ( lvm_available )
 	{
 		//The OS is expected to fully enable LVM, this scan does
 		//  not do the full job.  It is included incase anything
@@ -239,18 +253,18 @@ void LVM2_PV_Info::load_lvm2_pv_info_cache()
 		{
 			if ( output != "" )
 			{
-				Utils::tokenize( output, lvm2_pv_cache, "\n" ) ;
-				for ( i = 0 ; i < lvm2_pv_cache .size() ; i ++ )
-					lvm2_pv_cache [i] = Utils::trim( lvm2_pv_cache [i] ) ;
+				Utils::tokenize( output, new_lvm2_pv_cache, "\n" ) ;
+				for ( i = 0 ; i < new_lvm2_pv_cache .size() ; i ++ )
+					new_lvm2_pv_cache [i] = Utils::trim( new_lvm2_pv_cache [i] ) ;
 			}
 		}
 		else
 		{
-			error_messages .push_back( cmd ) ;
+			new_error_messages .push_back( cmd ) ;
 			if ( ! output .empty() )
-				error_messages .push_back ( output ) ;
+				new_error_messages .push_back ( output ) ;
 			if ( ! error .empty() )
-				error_messages .push_back ( error ) ;
+				new_error_messages .push_back ( error ) ;
 		}
 
 		//Load LVM2 VG attribute cache.  Output VG and LV attributes in VG_ATTRIBUTE order
@@ -260,21 +274,21 @@ void LVM2_PV_Info::load_lvm2_pv_info_cache()
 		{
 			if ( output != "" )
 			{
-				Utils::tokenize( output, lvm2_vg_cache, "\n" ) ;
-				for ( i = 0 ; i < lvm2_vg_cache .size() ; i ++ )
-					lvm2_vg_cache [i] = Utils::trim( lvm2_vg_cache [i] ) ;
+				Utils::tokenize( output, new_lvm2_vg_cache, "\n" ) ;
+				for ( i = 0 ; i < new_lvm2_vg_cache .size() ; i ++ )
+					new_lvm2_vg_cache [i] = Utils::trim( new_lvm2_vg_cache [i] ) ;
 			}
 		}
 		else
 		{
-			error_messages .push_back( cmd ) ;
+			new_error_messages .push_back( cmd ) ;
 			if ( ! output .empty() )
-				error_messages .push_back ( output ) ;
+				new_error_messages .push_back ( output ) ;
 			if ( ! error .empty() )
-				error_messages .push_back ( error ) ;
+				new_error_messages .push_back ( error ) ;
 		}
 
-		if ( ! error_messages .empty() )
+		if ( ! new_error_messages .empty() )
 		{
 			Glib::ustring temp ;
 			temp = _("An error occurred reading LVM2 configuration!") ;
@@ -282,9 +296,15 @@ void LVM2_PV_Info::load_lvm2_pv_info_cache()
 			temp += _("Some or all of the details might be missing or incorrect.") ;
 			temp += "\n" ;
 			temp += _("You should NOT modify any LVM2 PV partitions.") ;
-			error_messages .push_back( temp ) ;
+			new_error_messages .push_back( temp ) ;
 		}
 	}
+
+	Glib::Mutex::Lock lock( mutex ) ;
+	lvm2_pv_cache .swap( new_lvm2_pv_cache ) ;
+	lvm2_vg_cache .swap( new_lvm2_vg_cache ) ;
+	error_messages .swap( new_error_messages ) ;
+	lvm2_pv_info_cache_initialized = true ;
 }
 
 Glib::ustring LVM2_PV_Info::get_pv_attr_by_path( const Glib::ustring & path, unsigned int entry ) const
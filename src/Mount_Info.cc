@@ -0,0 +1,195 @@
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#include "../include/Mount_Info.h"
+#include "../include/FS_Info.h"
+
+#include <glibmm/fileutils.h>
+#include <fstream>
+#include <algorithm>
+#include <cstdlib>
+#include <mntent.h>
+
+namespace GParted
+{
+
+//Initialize static data elements
+Glib::Mutex Mount_Info::mutex ;
+bool Mount_Info::mount_info_cache_initialized = false ;
+Mount_Info::MountMap Mount_Info::mount_info ;
+Mount_Info::MountMap Mount_Info::fstab_info ;
+
+Mount_Info::Mount_Info()
+{
+	//Ensure that cache has been loaded at least once
+	{
+		Glib::Mutex::Lock lock( mutex ) ;
+		if ( mount_info_cache_initialized )
+			return ;
+	}
+
+	load_mount_info_cache() ;
+}
+
+Mount_Info::Mount_Info( bool do_refresh )
+{
+	{
+		Glib::Mutex::Lock lock( mutex ) ;
+		if ( mount_info_cache_initialized && ! do_refresh )
+			return ;
+	}
+
+	load_mount_info_cache() ;
+}
+
+Mount_Info::~Mount_Info()
+{
+}
+
+//Whether the file system or swap space at path is in use
+bool Mount_Info::is_mounted( const Glib::ustring & path )
+{
+	Glib::Mutex::Lock lock( mutex ) ;
+	return mount_info .find( path ) != mount_info .end() ;
+}
+
+std::vector<Glib::ustring> Mount_Info::get_mounted_mountpoints( const Glib::ustring & path )
+{
+	Glib::Mutex::Lock lock( mutex ) ;
+	MountMap::const_iterator iter = mount_info .find( path ) ;
+	if ( iter != mount_info .end() )
+		return iter ->second ;
+
+	return std::vector<Glib::ustring>() ;
+}
+
+std::vector<Glib::ustring> Mount_Info::get_fstab_mountpoints( const Glib::ustring & path )
+{
+	Glib::Mutex::Lock lock( mutex ) ;
+	MountMap::const_iterator iter = fstab_info .find( path ) ;
+	if ( iter != fstab_info .end() )
+		return iter ->second ;
+
+	return std::vector<Glib::ustring>() ;
+}
+
+std::vector<Glib::ustring> Mount_Info::get_all_mountpoints()
+{
+	std::vector<Glib::ustring> mountpoints ;
+
+	Glib::Mutex::Lock lock( mutex ) ;
+	for ( MountMap::const_iterator iter = mount_info .begin() ; iter != mount_info .end() ; ++iter )
+		mountpoints .insert( mountpoints .end(), iter ->second .begin(), iter ->second .end() ) ;
+
+	return mountpoints ;
+}
+
+//Private Methods
+
+//The files are read without holding the lock, so readers aren't held up, and the
+//  new maps then replace the old ones at once
+void Mount_Info::load_mount_info_cache()
+{
+	MountMap new_mount_info ;
+	MountMap new_fstab_info ;
+
+	read_mountpoints_from_file( "/proc/mounts", new_mount_info ) ;
+	read_mountpoints_from_file_swaps( "/proc/swaps", new_mount_info ) ;
+	read_mountpoints_from_file( "/etc/mtab", new_mount_info ) ;
+	read_mountpoints_from_file( "/etc/fstab", new_fstab_info ) ;
+
+	//sort the mount points and remove duplicates.. (no need to do this for fstab_info)
+	for ( MountMap::iterator iter = new_mount_info .begin() ; iter != new_mount_info .end() ; ++iter )
+	{
+		std::sort( iter ->second .begin(), iter ->second .end() ) ;
+
+		iter ->second .erase(
+				std::unique( iter ->second .begin(), iter ->second .end() ),
+				iter ->second .end() ) ;
+	}
+
+	Glib::Mutex::Lock lock( mutex ) ;
+	mount_info .swap( new_mount_info ) ;
+	fstab_info .swap( new_fstab_info ) ;
+	mount_info_cache_initialized = true ;
+}
+
+void Mount_Info::read_mountpoints_from_file( const Glib::ustring & filename, MountMap & map )
+{
+	FS_Info fs_info ;  //Use cache of file system information
+
+	FILE* fp = setmntent( filename .c_str(), "r" ) ;
+
+	if ( fp == NULL )
+		return ;
+
+	struct mntent* p = NULL ;
+
+	while ( (p = getmntent(fp)) != NULL )
+	{
+		Glib::ustring node = p->mnt_fsname ;
+
+		Glib::ustring uuid = Utils::regexp_label( node, "^UUID=(.*)" ) ;
+		if ( ! uuid .empty() )
+			node = fs_info .get_path_by_uuid( uuid ) ;
+
+		Glib::ustring label = Utils::regexp_label( node, "^LABEL=(.*)" ) ;
+		if ( ! label .empty() )
+			node = fs_info .get_path_by_label( label ) ;
+
+		if ( ! node .empty() )
+		{
+			Glib::ustring mountpoint = p->mnt_dir ;
+
+			//Only add node path(s) if mount point exists
+			if ( file_test( mountpoint, Glib::FILE_TEST_EXISTS ) )
+			{
+				map[ node ] .push_back( mountpoint ) ;
+
+				//If node is a symbolic link (e.g., /dev/root)
+				//  then find real path and add entry
+				if ( file_test( node, Glib::FILE_TEST_IS_SYMLINK ) )
+				{
+					char c_str[4096+1] ;
+					//FIXME: it seems realpath is very unsafe to use (manpage)...
+					if ( realpath( node .c_str(), c_str ) != NULL )
+						map[ c_str ] .push_back( mountpoint ) ;
+				}
+			}
+		}
+	}
+
+	endmntent( fp ) ;
+}
+
+void Mount_Info::read_mountpoints_from_file_swaps( const Glib::ustring & filename, MountMap & map )
+{
+	std::string line ;
+	std::string node ;
+
+	std::ifstream file( filename .c_str() ) ;
+	if ( file )
+	{
+		while ( getline( file, line ) )
+		{
+			node = Utils::regexp_label( line, "^(/[^ ]+)" ) ;
+			if ( node .size() > 0 )
+				map[ node ] .push_back( "" /* no mountpoint for swap */ ) ;
+		}
+		file .close() ;
+	}
+}
+
+}//GParted
@@ -17,11 +17,59 @@
  */
 #include "../include/Operation.h"
 
+#include <glibmm/thread.h>
+
 namespace GParted
 {
 
-Operation::Operation()
+std::map< Glib::ustring, Operation::DeviceSnapshot * > Operation::device_snapshots ;
+
+//Guards device_snapshots and the release of the last reference to a snapshot
+static Glib::Mutex device_snapshots_mutex ;
+
+Operation::DeviceSnapshot::DeviceSnapshot( const Device & device ) : device( device ), ref_count( 1 )
+{
+}
+
+void Operation::DeviceSnapshot::reference() const
+{
+	g_atomic_int_inc( & ref_count ) ;
+}
+
+void Operation::DeviceSnapshot::unreference() const
+{
+	Glib::Mutex::Lock lock( device_snapshots_mutex ) ;
+	if ( g_atomic_int_dec_and_test( & ref_count ) )
+	{
+		std::map< Glib::ustring, DeviceSnapshot * >::iterator iter =
+			device_snapshots .find( device .get_path() ) ;
+		if ( iter != device_snapshots .end() && iter ->second == this )
+			device_snapshots .erase( iter ) ;
+		delete this ;
+	}
+}
+
+Operation::Operation( const Device & device )
+	: snapshot( get_device_snapshot( device ) ), device( snapshot ->device )
+{
+}
+
+//Return the snapshot of the device, reusing the one of earlier operations
+//  when the device hasn't been rescanned since
+Glib::RefPtr<Operation::DeviceSnapshot> Operation::get_device_snapshot( const Device & device )
 {
+	Glib::Mutex::Lock lock( device_snapshots_mutex ) ;
+	std::map< Glib::ustring, DeviceSnapshot * >::iterator iter =
+		device_snapshots .find( device .get_path() ) ;
+	if ( iter != device_snapshots .end() && iter ->second ->device .generation == device .generation )
+	{
+		iter ->second ->reference() ;
+		return Glib::RefPtr<DeviceSnapshot>( iter ->second ) ;
+	}
+
+	DeviceSnapshot * snapshot = new DeviceSnapshot( device ) ;
+	device_snapshots[ device .get_path() ] = snapshot ;
+	return Glib::RefPtr<DeviceSnapshot>( snapshot ) ;
 }
 	
 int Operation::find_index_original( const std::vector<Partition> & partitions ) 
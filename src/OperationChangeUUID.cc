@@ -24,10 +24,10 @@ OperationChangeUUID::OperationChangeUUID( const Device & device
                                         , const Partition & partition_orig
                                         , const Partition & partition_new
                                         )
+	: Operation( device )
 {
 	type = OPERATION_CHANGE_UUID ;
 
-	this ->device = device ;
 	this ->partition_original = partition_orig ;
 	this ->partition_new = partition_new ;
 }
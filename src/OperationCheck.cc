@@ -21,10 +21,10 @@ namespace GParted
 {
 
 OperationCheck::OperationCheck( const Device & device, const Partition & partition )
+	: Operation( device )
 {
 	type = OPERATION_CHECK ;
 
-	this ->device = device ;
 	partition_original = partition ;
 }
 	
@@ -24,10 +24,10 @@ namespace GParted
 OperationCreate::OperationCreate( const Device & device,
 				  const Partition & partition_orig,
 				  const Partition & partition_new )
+	: Operation( device )
 {
 	type = OPERATION_CREATE ;
 
-	this ->device = device ;
 	this ->partition_original = partition_orig ;
 	this ->partition_new = partition_new ;
 }
@@ -22,10 +22,10 @@ namespace GParted
 {
 
 OperationDelete::OperationDelete( const Device & device, const Partition & partition_orig )
+	: Operation( device )
 {
 	type = OPERATION_DELETE ;
 
-	this ->device = device ;
 	this ->partition_original = partition_orig ;
 }
 	
@@ -19,10 +19,44 @@
 #include "../include/OperationDetail.h"
 #include "../include/Utils.h"
 
+#include <glibmm/fileutils.h>
+#include <glibmm/thread.h>
+#include <cstdio>
+#include <unistd.h>
+
 namespace GParted
 {
 
-OperationDetail::OperationDetail()
+//Command output longer than this many characters is written to a log file, with
+//  only the first and last part kept in memory
+const Glib::ustring::size_type MAX_OUTPUT_CHARS = 64 * 1024 ;
+const Glib::ustring::size_type OUTPUT_HEAD_CHARS = 16 * 1024 ;
+const Glib::ustring::size_type OUTPUT_TAIL_CHARS = 16 * 1024 ;
+
+//Log files written for large command outputs, removed when the program exits
+class LogFiles
+{
+public:
+	~LogFiles()
+	{
+		for ( unsigned int t = 0 ; t < files .size() ; t++ )
+			remove( files[ t ] .c_str() ) ;
+	}
+
+	void add( const std::string & filename )
+	{
+		Glib::Mutex::Lock lock( mutex ) ;
+		files .push_back( filename ) ;
+	}
+
+private:
+	Glib::Mutex mutex ;
+	std::vector<std::string> files ;
+} ;
+
+static LogFiles log_files ;
+
+OperationDetail::OperationDetail() : parent( NULL )
 {
 	status = STATUS_NONE; // prevent uninitialized member access
 	set_status( STATUS_NONE ) ;
@@ -31,6 +65,7 @@ OperationDetail::OperationDetail()
 }
 
 OperationDetail::OperationDetail( const Glib::ustring & description, OperationDetailStatus status, Font font )
+	: parent( NULL )
 {
 	this ->status = STATUS_NONE; // prevent uninitialized member access
 	set_description( description, font ) ;
@@ -40,6 +75,47 @@ OperationDetail::OperationDetail( const Glib::ustring & description, OperationDe
 	time_elapsed = -1 ;
 }
 
+//A copy is a new root.  It doesn't inherit the signal connections of the original.
+OperationDetail::OperationDetail( const OperationDetail & other )
+	: fraction( other .fraction ),
+	  progress_text( other .progress_text ),
+	  description( other .description ),
+	  status( other .status ),
+	  treepath( other .treepath ),
+	  parent( NULL ),
+	  time_start( other .time_start ),
+	  time_elapsed( other .time_elapsed ),
+	  log_file( other .log_file )
+{
+	copy_children( other ) ;
+}
+
+OperationDetail & OperationDetail::operator=( const OperationDetail & other )
+{
+	if ( this != & other )
+	{
+		fraction      = other .fraction ;
+		progress_text = other .progress_text ;
+		description   = other .description ;
+		status        = other .status ;
+		treepath      = other .treepath ;
+		time_start    = other .time_start ;
+		time_elapsed  = other .time_elapsed ;
+
+		log_file      = other .log_file ;
+
+		delete_children() ;
+		copy_children( other ) ;
+	}
+
+	return *this ;
+}
+
+OperationDetail::~OperationDetail()
+{
+	delete_children() ;
+}
+
 void OperationDetail::set_description( const Glib::ustring & description, Font font )
 {
 	try
@@ -68,7 +144,7 @@ void OperationDetail::set_description( const Glib::ustring & description, Font f
 	on_update( *this ) ;
 }
 
-Glib::ustring OperationDetail::get_description() const
+const Glib::ustring & OperationDetail::get_description() const
 {
 	return description ;
 }
@@ -97,6 +173,16 @@ void OperationDetail::set_status( OperationDetailStatus status )
 	}
 }
 
+//Set fraction and progress_text and pass them on, for work which reports its
+//  progress without changing the description
+void OperationDetail::set_progress( double fraction, const Glib::ustring & progress_text )
+{
+	this ->fraction = fraction ;
+	this ->progress_text = progress_text ;
+
+	on_update( *this ) ;
+}
+
 OperationDetailStatus OperationDetail::get_status() const
 {
 	return status ;
@@ -107,7 +193,7 @@ void OperationDetail::set_treepath( const Glib::ustring & treepath )
 	this ->treepath = treepath ;
 }
 
-Glib::ustring OperationDetail::get_treepath() const
+const Glib::ustring & OperationDetail::get_treepath() const
 {
 	return treepath ;
 }
@@ -122,22 +208,75 @@ Glib::ustring OperationDetail::get_elapsed_time() const
 
 void OperationDetail::add_child( const OperationDetail & operationdetail ) 
 {
-	sub_details .push_back( operationdetail ) ;
+	OperationDetail * child = new OperationDetail( operationdetail ) ;
+	child ->parent = this ;
+	sub_details .push_back( child ) ;
 
-	sub_details .back() .set_treepath( treepath + ":" + Utils::num_to_str( sub_details .size() -1 ) ) ;
-	sub_details .back() .signal_update .connect( sigc::mem_fun( this, &OperationDetail::on_update ) ) ;
+	child ->set_treepath( treepath + ":" + Utils::num_to_str( sub_details .size() -1 ) ) ;
+	
+	on_update( *child ) ;
+}
 	
-	on_update( sub_details .back() ) ;
+//Add the output of a command as an italic child.  Large output is written to a
+//  temporary log file, keeping only its start and end in the tree.
+void OperationDetail::add_child_output( const Glib::ustring & output )
+{
+	Glib::ustring::size_type length = output .size() ;
+	if ( length <= MAX_OUTPUT_CHARS )
+	{
+		add_child( OperationDetail( output, STATUS_NONE, FONT_ITALIC ) ) ;
+		return ;
+	}
+
+	std::string filename ;
+	bool written = false ;
+	try
+	{
+		int fd = Glib::file_open_tmp( filename, "gparted-output-" ) ;
+		const std::string & bytes = output .raw() ;
+		std::string::size_type done = 0 ;
+		ssize_t count = 0 ;
+		while ( done < bytes .length() &&
+		        ( count = write( fd, bytes .data() + done, bytes .length() - done ) ) > 0 )
+			done += count ;
+		close( fd ) ;
+
+		written = done == bytes .length() ;
+		if ( ! written )
+			remove( filename .c_str() ) ;
+	}
+	catch ( Glib::FileError & e )
+	{
+	}
+
+	Glib::ustring omitted ;
+	if ( written )
+		omitted = String::ucompose( _("[%1 characters omitted, the complete output is in %2]"),
+		                            length - OUTPUT_HEAD_CHARS - OUTPUT_TAIL_CHARS,
+		                            filename ) ;
+	else
+		omitted = String::ucompose( _("[%1 characters omitted]"),
+		                            length - OUTPUT_HEAD_CHARS - OUTPUT_TAIL_CHARS ) ;
+
+	add_child( OperationDetail( output .substr( 0, OUTPUT_HEAD_CHARS ) + "\n\n" + omitted + "\n\n" +
+	                            output .substr( length - OUTPUT_TAIL_CHARS ),
+	                            STATUS_NONE, FONT_ITALIC ) ) ;
+
+	if ( written )
+	{
+		sub_details .back() ->log_file = filename ;
+		log_files .add( filename ) ;
+	}
 }
 	
-std::vector<OperationDetail> & OperationDetail::get_childs() 
+const std::vector<OperationDetail *> & OperationDetail::get_childs() const
 {
 	return sub_details ;
 }
 
-const std::vector<OperationDetail> & OperationDetail::get_childs() const
+const Glib::ustring & OperationDetail::get_log_file() const
 {
-	return sub_details ;
+	return log_file ;
 }
 
 OperationDetail & OperationDetail::get_last_child()
@@ -146,13 +285,31 @@ OperationDetail & OperationDetail::get_last_child()
 	if ( sub_details .size() == 0 )
 		add_child( OperationDetail( "---", STATUS_ERROR ) ) ;
 
-	return sub_details .back() ;
+	return *sub_details .back() ;
 }
 
+//Report the change to the listeners of this detail and of all its ancestors
 void OperationDetail::on_update( const OperationDetail & operationdetail ) 
 {
-	if ( ! treepath .empty() )
-		signal_update .emit( operationdetail ) ;
+	for ( OperationDetail * od = this ; od && ! od ->treepath .empty() ; od = od ->parent )
+		od ->signal_update .emit( operationdetail ) ;
+}
+
+void OperationDetail::copy_children( const OperationDetail & other )
+{
+	for ( unsigned int t = 0 ; t < other .sub_details .size() ; t++ )
+	{
+		OperationDetail * child = new OperationDetail( *other .sub_details[ t ] ) ;
+		child ->parent = this ;
+		sub_details .push_back( child ) ;
+	}
+}
+
+void OperationDetail::delete_children()
+{
+	for ( unsigned int t = 0 ; t < sub_details .size() ; t++ )
+		delete sub_details[ t ] ;
+	sub_details .clear() ;
 }
 
 } //GParted
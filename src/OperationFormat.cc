@@ -23,10 +23,10 @@ namespace GParted
 OperationFormat::OperationFormat( const Device & device,
 				  const Partition & partition_orig,
 				  const Partition & partition_new )
+	: Operation( device )
 {
 	type = OPERATION_FORMAT ;
 
-	this ->device = device ;
 	this ->partition_original = partition_orig ;
 	this ->partition_new = partition_new ;
 }
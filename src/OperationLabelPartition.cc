@@ -23,10 +23,10 @@ namespace GParted
 OperationLabelPartition::OperationLabelPartition( const Device & device,
 		const Partition & partition_orig,
 		const Partition & partition_new )
+	: Operation( device )
 {
 	type = OPERATION_LABEL_PARTITION ;
 
-	this ->device = device ;
 	this ->partition_original = partition_orig ;
 	this ->partition_new = partition_new ;
 }
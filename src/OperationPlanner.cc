@@ -0,0 +1,337 @@
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#include "../include/OperationPlanner.h"
+#include "../include/OperationCopy.h"
+
+#include <algorithm>
+#include <set>
+
+namespace GParted
+{
+
+OperationPlanner::OperationPlanner( const std::vector<Operation *> & operations )
+{
+	std::set<Glib::ustring> devices ;
+	for ( unsigned int t = 0 ; t < operations .size() ; t++ )
+	{
+		Step step ;
+		step .operation = operations[ t ] ;
+		step .partition_original = operations[ t ] ->partition_original ;
+		step .partition_new = operations[ t ] ->partition_new ;
+		queued .push_back( step ) ;
+
+		//the layout of each disk as scanned, before any of the operations
+		const Device & device = operations[ t ] ->device ;
+		if ( ! devices .insert( device .get_path() ) .second )
+			continue ;
+		for ( unsigned int p = 0 ; p < device .partitions .size() ; p++ )
+		{
+			const Partition & partition = device .partitions[ p ] ;
+			if ( partition .type == TYPE_UNALLOCATED )
+				continue ;
+			Extent extent = { device .get_path(), partition .sector_start, partition .sector_end, partition .type } ;
+			initial_extents .push_back( extent ) ;
+
+			for ( unsigned int l = 0 ; l < partition .logicals .size() ; l++ )
+			{
+				const Partition & logical = partition .logicals[ l ] ;
+				if ( logical .type == TYPE_UNALLOCATED )
+					continue ;
+				Extent logical_extent = { device .get_path(), logical .sector_start, logical .sector_end, logical .type } ;
+				initial_extents .push_back( logical_extent ) ;
+			}
+		}
+	}
+	plan = queued ;
+}
+
+//Rewrite the plan until no rule applies any more.  Returns true when the plan
+//  differs from the queue.
+bool OperationPlanner::optimize()
+{
+	//leave a queue alone which the simulation doesn't understand
+	if ( ! is_valid( queued ) )
+		return false ;
+
+	bool changed = false ;
+	while ( collapse_moves( plan ) || drop_move_before_delete( plan ) )
+		changed = true ;
+
+	return changed ;
+}
+
+Byte_Value OperationPlanner::get_queued_bytes() const
+{
+	return get_bytes_moved( queued ) ;
+}
+
+Byte_Value OperationPlanner::get_planned_bytes() const
+{
+	return get_bytes_moved( plan ) ;
+}
+
+unsigned int OperationPlanner::get_removed_operations() const
+{
+	return queued .size() - plan .size() ;
+}
+
+//Replace the queued operations with the plan.  Operations which are no longer
+//  needed are deleted.
+void OperationPlanner::apply( std::vector<Operation *> & operations ) const
+{
+	std::vector<Operation *> planned ;
+	for ( unsigned int t = 0 ; t < plan .size() ; t++ )
+	{
+		Operation * operation = plan[ t ] .operation ;
+		operation ->partition_original = plan[ t ] .partition_original ;
+		operation ->partition_new = plan[ t ] .partition_new ;
+		operation ->create_description() ;
+		planned .push_back( operation ) ;
+	}
+
+	for ( unsigned int t = 0 ; t < operations .size() ; t++ )
+		if ( std::find( planned .begin(), planned .end(), operations[ t ] ) == planned .end() )
+			delete operations[ t ] ;
+
+	operations = planned ;
+}
+
+//Private Methods
+
+//Replace two moves of the same partition, with other operations in between, by
+//  one move.  It is done where the second move was, when the space it moves into
+//  is surely free, or else at the latest point where the plan is still valid.
+//  Moving a partition back to where it was removes both moves.
+bool OperationPlanner::collapse_moves( std::vector<Step> & plan ) const
+{
+	for ( unsigned int i = 0 ; i < plan .size() ; i++ )
+	{
+		if ( plan[ i ] .operation ->type != OPERATION_RESIZE_MOVE ||
+		     plan[ i ] .partition_original .type == TYPE_EXTENDED )
+			continue ;
+		int j = find_next_step( plan, i ) ;
+		if ( j < 0 || plan[ j ] .operation ->type != OPERATION_RESIZE_MOVE )
+			continue ;
+
+		Step merged = plan[ i ] ;
+		merged .partition_new = plan[ j ] .partition_new ;
+		std::vector<Step> rest = plan ;
+		rest .erase( rest .begin() + j ) ;
+		rest .erase( rest .begin() + i ) ;
+
+		if ( same_place( merged .partition_original, merged .partition_new ) )
+		{
+			if ( is_valid( rest ) )
+			{
+				plan = rest ;
+				return true ;
+			}
+			continue ;
+		}
+
+		for ( int position = j - 1 ; position >= int( i ) ; position-- )
+		{
+			std::vector<Step> candidate = rest ;
+			candidate .insert( candidate .begin() + position, merged ) ;
+			if ( is_valid( candidate ) )
+			{
+				plan = candidate ;
+				return true ;
+			}
+		}
+	}
+
+	return false ;
+}
+
+//A partition which is moved and later deleted doesn't need to be moved
+bool OperationPlanner::drop_move_before_delete( std::vector<Step> & plan ) const
+{
+	for ( unsigned int i = 0 ; i < plan .size() ; i++ )
+	{
+		if ( plan[ i ] .operation ->type != OPERATION_RESIZE_MOVE ||
+		     plan[ i ] .partition_original .type == TYPE_EXTENDED )
+			continue ;
+		int j = find_next_step( plan, i ) ;
+		if ( j < 0 || plan[ j ] .operation ->type != OPERATION_DELETE )
+			continue ;
+
+		std::vector<Step> candidate = plan ;
+		candidate[ j ] .partition_original = plan[ i ] .partition_original ;
+		candidate .erase( candidate .begin() + i ) ;
+		if ( is_valid( candidate ) )
+		{
+			plan = candidate ;
+			return true ;
+		}
+	}
+
+	return false ;
+}
+
+//The first step after index which uses the partition resulting from that step,
+//  either as the partition it works on or as the source of a copy.  -1 if none.
+int OperationPlanner::find_next_step( const std::vector<Step> & plan, unsigned int index ) const
+{
+	const Partition & partition = plan[ index ] .partition_new ;
+	for ( unsigned int t = index + 1 ; t < plan .size() ; t++ )
+	{
+		if ( same_place( plan[ t ] .partition_original, partition ) )
+			return t ;
+		if ( plan[ t ] .operation ->type == OPERATION_COPY &&
+		     same_place( static_cast<OperationCopy *>( plan[ t ] .operation ) ->partition_copied, partition ) )
+			return t ;
+	}
+
+	return -1 ;
+}
+
+//Simulate the plan on the disk layouts as scanned
+bool OperationPlanner::is_valid( const std::vector<Step> & plan ) const
+{
+	std::vector<Extent> extents = initial_extents ;
+	for ( unsigned int t = 0 ; t < plan .size() ; t++ )
+		if ( ! apply_step( plan[ t ], extents ) || ! layout_valid( extents ) )
+			return false ;
+
+	return true ;
+}
+
+//Update the layout for one step.  Returns false when the partition the step
+//  works on isn't there at that point.
+bool OperationPlanner::apply_step( const Step & step, std::vector<Extent> & extents )
+{
+	const Partition & original = step .partition_original ;
+	const Partition & partition = step .partition_new ;
+	int index = -1 ;
+	for ( unsigned int t = 0 ; t < extents .size() && index < 0 ; t++ )
+		if ( extents[ t ] .device_path == original .device_path &&
+		     extents[ t ] .sector_start == original .sector_start &&
+		     extents[ t ] .sector_end == original .sector_end )
+			index = t ;
+
+	Extent extent = { partition .device_path, partition .sector_start, partition .sector_end, partition .type } ;
+	switch ( step .operation ->type )
+	{
+		case OPERATION_DELETE:
+			if ( index < 0 )
+				return false ;
+			extents .erase( extents .begin() + index ) ;
+			break ;
+		case OPERATION_CREATE:
+			extents .push_back( extent ) ;
+			break ;
+		case OPERATION_COPY:
+			//either pasted into unallocated space or over an existing partition
+			if ( index < 0 )
+				extents .push_back( extent ) ;
+			else
+				extents[ index ] = extent ;
+			break ;
+		case OPERATION_RESIZE_MOVE:
+			if ( index < 0 )
+				return false ;
+			extents[ index ] = extent ;
+			break ;
+		default:
+			if ( index < 0 )
+				return false ;
+			break ;
+	}
+
+	return true ;
+}
+
+//Partitions don't overlap and logical partitions lie inside the extended
+//  partition.  The sector before a logical partition holds its EBR, so it has
+//  to be free too.
+bool OperationPlanner::layout_valid( const std::vector<Extent> & extents )
+{
+	for ( unsigned int a = 0 ; a < extents .size() ; a++ )
+	{
+		const Extent & first = extents[ a ] ;
+		if ( first .sector_start > first .sector_end )
+			return false ;
+
+		bool inside_extended = false ;
+		for ( unsigned int b = 0 ; b < extents .size() ; b++ )
+		{
+			const Extent & second = extents[ b ] ;
+			if ( a == b || first .device_path != second .device_path )
+				continue ;
+
+			if ( first .type == TYPE_LOGICAL && second .type == TYPE_EXTENDED &&
+			     first .sector_start > second .sector_start && first .sector_end <= second .sector_end )
+				inside_extended = true ;
+
+			//a logical and a primary partition are kept apart by the extended partition
+			if ( ( first .type == TYPE_LOGICAL ) != ( second .type == TYPE_LOGICAL ) )
+				continue ;
+
+			Sector first_start = first .type == TYPE_LOGICAL ? first .sector_start - 1 : first .sector_start ;
+			Sector second_start = second .type == TYPE_LOGICAL ? second .sector_start - 1 : second .sector_start ;
+			if ( first_start <= second .sector_end && second_start <= first .sector_end )
+				return false ;
+		}
+
+		if ( first .type == TYPE_LOGICAL && ! inside_extended )
+			return false ;
+	}
+
+	return true ;
+}
+
+bool OperationPlanner::same_place( const Partition & first, const Partition & second )
+{
+	return first .device_path == second .device_path &&
+	       first .sector_start == second .sector_start &&
+	       first .sector_end == second .sector_end ;
+}
+
+//Data which has to be read and written again elsewhere by a step.  Only moving
+//  the start of a partition and copying a partition move data.  Moving an extended
+//  partition only moves its boundaries.
+Byte_Value OperationPlanner::get_bytes_moved( const Step & step )
+{
+	const Partition * data = NULL ;
+	if ( step .operation ->type == OPERATION_RESIZE_MOVE &&
+	     step .partition_original .type != TYPE_EXTENDED &&
+	     step .partition_original .sector_start != step .partition_new .sector_start )
+		data = & step .partition_original ;
+	else if ( step .operation ->type == OPERATION_COPY )
+		data = & static_cast<OperationCopy *>( step .operation ) ->partition_copied ;
+	if ( ! data )
+		return 0 ;
+
+	Sector sectors = data ->get_sectors_used() ;
+	if ( sectors < 0 )
+		sectors = data ->get_sector_length() ;
+	if ( step .operation ->type == OPERATION_RESIZE_MOVE )
+		sectors = std::min( sectors, step .partition_new .get_sector_length() ) ;
+
+	return sectors * data ->sector_size ;
+}
+
+Byte_Value OperationPlanner::get_bytes_moved( const std::vector<Step> & plan )
+{
+	Byte_Value bytes = 0 ;
+	for ( unsigned int t = 0 ; t < plan .size() ; t++ )
+		bytes += get_bytes_moved( plan[ t ] ) ;
+
+	return bytes ;
+}
+
+}//GParted
@@ -24,9 +24,9 @@ namespace GParted
 OperationResizeMove::OperationResizeMove( const Device & device,
 				  	  const Partition & partition_orig,
 				  	  const Partition & partition_new )
+	: Operation( device )
 {
 	type = OPERATION_RESIZE_MOVE ;
-	this ->device = device ;
 	this ->partition_original = partition_orig ;
 	this ->partition_new = partition_new ;
 }
@@ -21,6 +21,30 @@
 namespace GParted
 {
 
+//Returned by the path and mount point accessors of a partition without any
+const std::vector<Glib::ustring> NO_NAMES ;
+const Glib::ustring NO_NAME ;
+
+Partition::Names::Names() : ref_count( 1 )
+{
+}
+
+Partition::Names::Names( const Names & other )
+	: paths( other .paths ), mountpoints( other .mountpoints ), ref_count( 1 )
+{
+}
+
+void Partition::Names::reference() const
+{
+	g_atomic_int_inc( & ref_count ) ;
+}
+
+void Partition::Names::unreference() const
+{
+	if ( g_atomic_int_dec_and_test( & ref_count ) )
+		delete this ;
+}
+
 Partition::Partition()
 {
 	Reset() ;
@@ -30,12 +54,12 @@ Partition::Partition( const Glib::ustring & path )
 {
 	Reset() ;
 
-	paths .push_back( path ) ;
+	get_names_for_write() .paths .push_back( path ) ;
 }
 
 void Partition::Reset()
 {
-	paths .clear() ;
+	names = Glib::RefPtr<Names>() ;
 	messages .clear() ;
 	status = GParted::STAT_REAL ;
 	type = GParted::TYPE_UNALLOCATED ;
@@ -52,7 +76,6 @@ void Partition::Reset()
 	inside_extended = busy = strict_start = raw = false ;
 	logicals .clear() ;
 	flags .clear() ;
-	mountpoints .clear() ;
 	device_path .clear() ;
 }
 
@@ -69,7 +92,7 @@ void Partition::Set(	const Glib::ustring & device_path,
 {
 	this ->device_path = device_path ;
 
-	paths .push_back( partition ) ;
+	get_names_for_write() .paths .push_back( partition ) ;
 
 	this ->partition_number = partition_number;
 	this ->type = type;
@@ -187,6 +210,13 @@ void Partition::Set_Unallocated( const Glib::ustring & device_path,
 
 void Partition::Update_Number( int new_number )
 {  
+	if ( ! names )
+	{
+		partition_number = new_number ;
+		return ;
+	}
+
+	std::vector<Glib::ustring> & paths = get_names_for_write() .paths ;
 	unsigned int index ;
 	for ( unsigned int t = 0 ; t < paths .size() ; t++ )
 	{
@@ -201,24 +231,30 @@ void Partition::Update_Number( int new_number )
 	partition_number = new_number;
 }
 	
+//The new path lists are built separately because the arguments may refer to
+//  this partition's own paths
 void Partition::add_path( const Glib::ustring & path, bool clear_paths ) 
 {
-	if ( clear_paths )
-		paths .clear() ;
+	std::vector<Glib::ustring> new_paths ;
+	if ( ! clear_paths )
+		new_paths = get_paths() ;
 
-	paths .push_back( path ) ;
+	new_paths .push_back( path ) ;
 
-	sort_paths_and_remove_duplicates() ;
+	sort_paths_and_remove_duplicates( new_paths ) ;
+	get_names_for_write() .paths .swap( new_paths ) ;
 }
 	
 void Partition::add_paths( const std::vector<Glib::ustring> & paths, bool clear_paths )
 {
-	if ( clear_paths )
-		this ->paths .clear() ;
+	std::vector<Glib::ustring> new_paths ;
+	if ( ! clear_paths )
+		new_paths = get_paths() ;
 
-	this ->paths .insert( this ->paths .end(), paths .begin(), paths .end() ) ;
+	new_paths .insert( new_paths .end(), paths .begin(), paths .end() ) ;
 
-	sort_paths_and_remove_duplicates() ;
+	sort_paths_and_remove_duplicates( new_paths ) ;
+	get_names_for_write() .paths .swap( new_paths ) ;
 }
 
 Byte_Value Partition::get_byte_length() const 
@@ -237,17 +273,20 @@ Sector Partition::get_sector_length() const
 		return -1 ;
 }
 
-Glib::ustring Partition::get_path() const
+const Glib::ustring & Partition::get_path() const
 {
-	if ( paths .size() > 0 )
-		return paths .front() ;
+	if ( get_paths() .size() > 0 )
+		return get_paths() .front() ;
 	
-	return "" ;
+	return NO_NAME ;
 }
 
-std::vector<Glib::ustring> Partition::get_paths() const
+const std::vector<Glib::ustring> & Partition::get_paths() const
 {
-	return paths ;
+	if ( names )
+		return names ->paths ;
+
+	return NO_NAMES ;
 }
 
 bool Partition::label_known() const
@@ -334,7 +373,7 @@ void Partition::get_usage_triple_helper( Sector stot, Sector s1, Sector s2, Sect
 	}
 }
 
-void Partition::sort_paths_and_remove_duplicates()
+void Partition::sort_paths_and_remove_duplicates( std::vector<Glib::ustring> & paths )
 {
 	//remove duplicates
 	std::sort( paths .begin(), paths .end() ) ;
@@ -346,31 +385,40 @@ void Partition::sort_paths_and_remove_duplicates()
 
 void Partition::add_mountpoint( const Glib::ustring & mountpoint, bool clear_mountpoints )
 {
-	if ( clear_mountpoints )
-		this ->mountpoints .clear() ;
+	std::vector<Glib::ustring> new_mountpoints ;
+	if ( ! clear_mountpoints )
+		new_mountpoints = get_mountpoints() ;
+
+	new_mountpoints .push_back( mountpoint ) ;
 
-	this ->mountpoints .push_back( mountpoint ) ;
+	get_names_for_write() .mountpoints .swap( new_mountpoints ) ;
 }
 
 void Partition::add_mountpoints( const std::vector<Glib::ustring> & mountpoints, bool clear_mountpoints ) 
 {
-	if ( clear_mountpoints )
-		this ->mountpoints .clear() ;
+	std::vector<Glib::ustring> new_mountpoints ;
+	if ( ! clear_mountpoints )
+		new_mountpoints = get_mountpoints() ;
+
+	new_mountpoints .insert( new_mountpoints .end(), mountpoints .begin(), mountpoints .end() ) ;
 
-	this ->mountpoints .insert( this ->mountpoints .end(), mountpoints .begin(), mountpoints .end() ) ;
+	get_names_for_write() .mountpoints .swap( new_mountpoints ) ;
 }
 
-Glib::ustring Partition::get_mountpoint() const 
+const Glib::ustring & Partition::get_mountpoint() const 
 {
-	if ( mountpoints .size() > 0 )
-		return mountpoints .front() ;
+	if ( get_mountpoints() .size() > 0 )
+		return get_mountpoints() .front() ;
 
-	return "" ;
+	return NO_NAME ;
 }
 
-std::vector<Glib::ustring> Partition::get_mountpoints() const 
+const std::vector<Glib::ustring> & Partition::get_mountpoints() const 
 {
-	return mountpoints ;
+	if ( names )
+		return names ->mountpoints ;
+
+	return NO_NAMES ;
 }
 
 Sector Partition::get_sector() const 
@@ -389,7 +437,20 @@ bool Partition::test_overlap( const Partition & partition ) const
 
 void Partition::clear_mountpoints()
 {
-	mountpoints .clear() ;
+	if ( names && ! names ->mountpoints .empty() )
+		get_names_for_write() .mountpoints .clear() ;
+}
+
+//Return the paths and mount points for modification, first making a private
+//  copy if they are shared with other partitions
+Partition::Names & Partition::get_names_for_write()
+{
+	if ( ! names )
+		names = Glib::RefPtr<Names>( new Names() ) ;
+	else if ( g_atomic_int_get( & names ->ref_count ) > 1 )
+		names = Glib::RefPtr<Names>( new Names( *names ) ) ;
+
+	return *names ;
 }
 
 bool Partition::compare_paths( const Glib::ustring & A, const Glib::ustring & B )
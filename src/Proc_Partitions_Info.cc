@@ -17,19 +17,26 @@
 
 #include "../include/Proc_Partitions_Info.h"
 
+#include <glibmm/fileutils.h>
 #include <fstream>
+#include <cctype>
+#include <set>
+#include <cstring>
 
 namespace GParted
 {
 
 //Initialize static data elements
+Glib::Mutex Proc_Partitions_Info::mutex ;
 bool Proc_Partitions_Info::proc_partitions_info_cache_initialized = false ;
 std::vector<Glib::ustring> Proc_Partitions_Info::device_paths_cache ;
 std::map< Glib::ustring, Glib::ustring > Proc_Partitions_Info::alternate_paths_cache ;
+std::map< Glib::ustring, std::vector<Glib::ustring> > Proc_Partitions_Info::multipath_members_cache ;
 
 Proc_Partitions_Info::Proc_Partitions_Info()
 {
 	//Ensure that cache has been loaded at least once
+	Glib::Mutex::Lock lock( mutex ) ;
 	if ( ! proc_partitions_info_cache_initialized )
 	{
 		proc_partitions_info_cache_initialized = true ;
@@ -40,6 +47,7 @@ Proc_Partitions_Info::Proc_Partitions_Info()
 Proc_Partitions_Info::Proc_Partitions_Info( bool do_refresh )
 {
 	//Ensure that cache has been loaded at least once
+	Glib::Mutex::Lock lock( mutex ) ;
 	if ( ! proc_partitions_info_cache_initialized )
 	{
 		proc_partitions_info_cache_initialized = true ;
@@ -57,6 +65,7 @@ Proc_Partitions_Info::~Proc_Partitions_Info()
 
 std::vector<Glib::ustring> Proc_Partitions_Info::get_device_paths()
 {
+	Glib::Mutex::Lock lock( mutex ) ;
 	return device_paths_cache ;
 }
 
@@ -65,6 +74,7 @@ std::vector<Glib::ustring> Proc_Partitions_Info::get_alternate_paths( const Glib
 	std::vector<Glib::ustring> paths ;
 	std::map< Glib::ustring, Glib::ustring >::iterator iter ;
 
+	Glib::Mutex::Lock lock( mutex ) ;
 	iter = alternate_paths_cache .find( path ) ;
 	if ( iter != alternate_paths_cache .end() )
 		paths .push_back( iter ->second ) ;
@@ -72,44 +82,52 @@ std::vector<Glib::ustring> Proc_Partitions_Info::get_alternate_paths( const Glib
 	return paths ;
 }
 
+//Paths of the devices which a multipath device is reached through, and which
+//  are therefore not listed by get_device_paths()
+std::vector<Glib::ustring> Proc_Partitions_Info::get_multipath_members( const Glib::ustring & path )
+{
+	Glib::Mutex::Lock lock( mutex ) ;
+	std::map< Glib::ustring, std::vector<Glib::ustring> >::iterator iter = multipath_members_cache .find( path ) ;
+	if ( iter != multipath_members_cache .end() )
+		return iter ->second ;
+
+	return std::vector<Glib::ustring>() ;
+}
+
 //Private Methods
+
+//Called with the mutex held.  Only files are read, no commands are run.
 void Proc_Partitions_Info::load_proc_partitions_info_cache()
 {
 	alternate_paths_cache .clear();
 	device_paths_cache .clear() ;
+	multipath_members_cache .clear() ;
+	std::vector<Glib::ustring> dm_names ;
 
 	//Initialize alternate_paths
 	std::ifstream proc_partitions( "/proc/partitions" ) ;
 	if ( proc_partitions )
 	{
 		std::string line ;
-		std::string device ;
 		char c_str[4096+1] ;
 
 		while ( getline( proc_partitions, line ) )
 		{
-			//Build cache of disk devices.
-			//Whole disk devices are the ones we want.
-			//Device names without a trailing digit refer to the whole disk.
-			device = Utils::regexp_label(line, "^[\t ]+[0-9]+[\t ]+[0-9]+[\t ]+[0-9]+[\t ]+([^0-9]+)$") ;
-			//Recognize /dev/mmcblk* devices.
-			//E.g., device = /dev/mmcblk0, partition = /dev/mmcblk0p1
-			if ( device == "" )
-				device = Utils::regexp_label(line, "^[\t ]+[0-9]+[\t ]+[0-9]+[\t ]+[0-9]+[\t ]+(mmcblk[0-9]+)$") ;
-			//Device names that end with a #[^p]# are HP Smart Array Devices (disks)
-			//E.g., device = /dev/cciss/c0d0, partition = /dev/cciss/c0d0p1
-			if ( device == "" )
-				device = Utils::regexp_label(line, "^[\t ]+[0-9]+[\t ]+[0-9]+[\t ]+[0-9]+[\t ]+(.*[0-9]+[^p]{1}[0-9]+)$") ;
-			if ( device != "" )
-			{
-				//add potential device to the list
-				device = "/dev/" + device;
-				device_paths_cache .push_back( device ) ;
-			}
-
-			//Build cache of potential alternate paths
 			if ( sscanf( line .c_str(), "%*d %*d %*d %4096s", c_str ) == 1 )
 			{
+				//Build cache of disk devices.
+				//  Whole disk devices are the ones we want.  The name is
+				//  checked by hand as /proc/partitions can list thousands of
+				//  loop and partition devices.
+				if ( is_whole_disk_name( c_str ) )
+				{
+					//add potential device to the list
+					device_paths_cache .push_back( Glib::ustring( "/dev/" ) + c_str ) ;
+				}
+				else if ( strncmp( c_str, "dm-", 3 ) == 0 )
+					dm_names .push_back( c_str ) ;
+
+				//Build cache of potential alternate paths
 				line = "/dev/" ; 
 				line += c_str ;
 
@@ -129,6 +147,115 @@ void Proc_Partitions_Info::load_proc_partitions_info_cache()
 		}
 		proc_partitions .close() ;
 	}
+
+	collapse_multipath_devices( dm_names ) ;
+}
+
+//Read the first line of a sysfs attribute, or "" when it doesn't exist
+static Glib::ustring read_sysfs_value( const Glib::ustring & filename )
+{
+	std::ifstream file( filename .c_str() ) ;
+	std::string line ;
+	if ( ! file || ! getline( file, line ) )
+		return "" ;
+
+	return Utils::trim( line ) ;
+}
+
+//Show a disk which is reachable over several paths only once.  A multipath map
+//  replaces the paths it is built on.  Of whole disks reporting the same globally
+//  unique WWID (NAA or EUI-64) and size, only the first is kept.  The paths left
+//  out are kept as members of the device which is shown.
+void Proc_Partitions_Info::collapse_multipath_devices( const std::vector<Glib::ustring> & dm_names )
+{
+	std::set<Glib::ustring> members ;
+
+	for ( unsigned int t = 0 ; t < dm_names .size() ; t++ )
+	{
+		Glib::ustring sysfs_dir = "/sys/block/" + dm_names[ t ] ;
+		if ( read_sysfs_value( sysfs_dir + "/dm/uuid" ) .substr( 0, 6 ) != "mpath-" )
+			continue ;
+
+		Glib::ustring map_name = read_sysfs_value( sysfs_dir + "/dm/name" ) ;
+		Glib::ustring map_path = map_name .empty() ? "/dev/" + dm_names[ t ] : "/dev/mapper/" + map_name ;
+		try
+		{
+			Glib::Dir slaves( sysfs_dir + "/slaves" ) ;
+			for ( Glib::DirIterator iter = slaves .begin() ; iter != slaves .end() ; ++iter )
+			{
+				//sysfs writes the '/' of names like cciss/c0d0 as '!'
+				Glib::ustring slave = *iter ;
+				for ( Glib::ustring::size_type index = slave .find( '!' ) ; index != Glib::ustring::npos ; index = slave .find( '!' ) )
+					slave .replace( index, 1, "/" ) ;
+
+				multipath_members_cache[ map_path ] .push_back( "/dev/" + slave ) ;
+				members .insert( "/dev/" + slave ) ;
+			}
+		}
+		catch ( Glib::FileError & e )
+		{
+		}
+
+		device_paths_cache .push_back( map_path ) ;
+	}
+
+	std::map< Glib::ustring, Glib::ustring > first_path_by_wwid ;
+	for ( unsigned int t = 0 ; t < device_paths_cache .size() ; t++ )
+	{
+		if ( members .count( device_paths_cache[ t ] ) || device_paths_cache[ t ] .substr( 0, 5 ) != "/dev/" )
+			continue ;
+
+		Glib::ustring sysfs_dir = "/sys/block/" + device_paths_cache[ t ] .substr( 5 ) ;
+		for ( Glib::ustring::size_type index = sysfs_dir .find( '/', 11 ) ; index != Glib::ustring::npos ; index = sysfs_dir .find( '/', 11 ) )
+			sysfs_dir .replace( index, 1, "!" ) ;
+
+		Glib::ustring wwid = read_sysfs_value( sysfs_dir + "/device/wwid" ) ;
+		if ( wwid .substr( 0, 4 ) != "naa." && wwid .substr( 0, 4 ) != "eui." )
+			continue ;
+
+		Glib::ustring key = wwid + " " + read_sysfs_value( sysfs_dir + "/size" ) ;
+		std::map< Glib::ustring, Glib::ustring >::iterator iter = first_path_by_wwid .find( key ) ;
+		if ( iter == first_path_by_wwid .end() )
+			first_path_by_wwid[ key ] = device_paths_cache[ t ] ;
+		else
+		{
+			multipath_members_cache[ iter ->second ] .push_back( device_paths_cache[ t ] ) ;
+			members .insert( device_paths_cache[ t ] ) ;
+		}
+	}
+
+	std::vector<Glib::ustring> device_paths ;
+	for ( unsigned int t = 0 ; t < device_paths_cache .size() ; t++ )
+		if ( ! members .count( device_paths_cache[ t ] ) )
+			device_paths .push_back( device_paths_cache[ t ] ) ;
+	device_paths_cache .swap( device_paths ) ;
+}
+
+bool Proc_Partitions_Info::is_whole_disk_name( const std::string & name )
+{
+	//Device names without a digit refer to the whole disk.
+	if ( name .find_first_of( "0123456789" ) == std::string::npos )
+		return true ;
+
+	//Recognize /dev/mmcblk* devices.
+	//E.g., device = /dev/mmcblk0, partition = /dev/mmcblk0p1
+	if (    name .size() > 6
+	     && name .compare( 0, 6, "mmcblk" ) == 0
+	     && name .find_first_not_of( "0123456789", 6 ) == std::string::npos )
+		return true ;
+
+	//Device names that end with a #[^p]# are HP Smart Array Devices (disks)
+	//E.g., device = /dev/cciss/c0d0, partition = /dev/cciss/c0d0p1
+	//  That is a digit, a character other than 'p' and one or more digits.
+	for ( std::string::size_type t = 0 ; t + 2 < name .size() ; t++ )
+	{
+		if (    isdigit( name[ t ] )
+		     && name[ t + 1 ] != 'p'
+		     && name .find_first_not_of( "0123456789", t + 2 ) == std::string::npos )
+			return true ;
+	}
+
+	return false ;
 }
 
 }//GParted
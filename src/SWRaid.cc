@@ -21,6 +21,7 @@ namespace GParted
 {
 
 //Initialize static data elements
+Glib::Mutex SWRaid::mutex ;
 bool SWRaid::swraid_cache_initialized = false ;
 bool SWRaid::mdadm_found  = false ;
 std::vector<Glib::ustring> SWRaid::swraid_devices ;
@@ -28,26 +29,14 @@ std::vector<Glib::ustring> SWRaid::swraid_devices ;
 SWRaid::SWRaid()
 {
 	//Ensure that cache has been loaded at least once
-	if ( ! swraid_cache_initialized )
-	{
-		swraid_cache_initialized = true ;
-		set_commands_found() ;
+	if ( set_commands_found() )
 		load_swraid_cache() ;
-	}
 }
 
 SWRaid::SWRaid( const bool & do_refresh )
 {
 	//Ensure that cache has been loaded at least once
-	if ( ! swraid_cache_initialized )
-	{
-		swraid_cache_initialized = true ;
-		set_commands_found() ;
-		if ( do_refresh == false )
-			load_swraid_cache() ;
-	}
-
-	if ( do_refresh )
+	if ( set_commands_found() || do_refresh )
 		load_swraid_cache() ;
 }
 
@@ -57,9 +46,9 @@ SWRaid::~SWRaid()
 
 void SWRaid::load_swraid_cache()
 {
-	//Load data into swraid structures
+	//Load data into swraid structures.  The command runs without holding the lock.
 	Glib::ustring output, error ;
-	swraid_devices .clear() ;
+	std::vector<Glib::ustring> devices ;
 
 	if ( mdadm_found )
 	{
@@ -73,17 +62,26 @@ void SWRaid::load_swraid_cache()
 				{
 					Glib::ustring temp = Utils::regexp_label( temp_arr[k], "^[^/]*(/dev/[^\t ]*)" ) ;
 					if ( temp .size() > 0 )
-						swraid_devices .push_back( temp ) ;
+						devices .push_back( temp ) ;
 				}
 			}
 		}
 	}
+
+	Glib::Mutex::Lock lock( mutex ) ;
+	swraid_devices .swap( devices ) ;
 }
 
-void SWRaid::set_commands_found()
+//Set status of commands found, the first time only.  Returns whether it did.
+bool SWRaid::set_commands_found()
 {
-	//Set status of commands found 
+	Glib::Mutex::Lock lock( mutex ) ;
+	if ( swraid_cache_initialized )
+		return false ;
+
+	swraid_cache_initialized = true ;
 	mdadm_found = (! Glib::find_program_in_path( "mdadm" ) .empty() ) ;
+	return true ;
 }
 
 bool SWRaid::is_swraid_supported()
@@ -97,6 +95,7 @@ void SWRaid::get_devices( std::vector<Glib::ustring> & device_list )
 	//Retrieve list of Linux software RAID devices
 	device_list .clear() ;
 
+	Glib::Mutex::Lock lock( mutex ) ;
 	for ( unsigned int k=0; k < swraid_devices .size(); k++ )
 		device_list .push_back( swraid_devices[k] ) ;
 }
@@ -0,0 +1,222 @@
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#include "../include/ThroughputModel.h"
+
+#include <glibmm/miscutils.h>
+#include <glib/gstdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fstream>
+#include <cstdlib>
+#include <cstdio>
+#include <algorithm>
+
+namespace GParted
+{
+
+//Weight of the history when a new measurement is added
+static const double DECAY = 0.7 ;
+
+//Initialize static data elements
+Glib::Mutex ThroughputModel::mutex ;
+bool ThroughputModel::loaded = false ;
+bool ThroughputModel::changed = false ;
+std::map<Glib::ustring, ThroughputModel::History> ThroughputModel::history ;
+std::map<Glib::ustring, Glib::ustring> ThroughputModel::device_ids ;
+
+//Called for each device scanned, so that measurements of a disk are found again
+//  by its model and size
+void ThroughputModel::add_device( const Glib::ustring & device_path, const Glib::ustring & model, Sector length )
+{
+	Glib::Mutex::Lock lock( mutex ) ;
+	device_ids[ device_path ] = model + " " + Utils::num_to_str( length ) ;
+}
+
+void ThroughputModel::record_read( const Glib::ustring & device_path, Byte_Value bytes, double seconds )
+{
+	record( get_device_key( "read", device_path ), bytes, seconds ) ;
+}
+
+//A copy reads and writes, so its throughput is kept for the destination disk
+void ThroughputModel::record_copy( const Glib::ustring & dst_device_path, Byte_Value bytes, double seconds )
+{
+	record( get_device_key( "copy", dst_device_path ), bytes, seconds ) ;
+}
+
+void ThroughputModel::record_command( const Glib::ustring & action, FILESYSTEM filesystem,
+                                      Byte_Value bytes, double seconds )
+{
+	record( action + ":" + Utils::get_filesystem_string( filesystem ), bytes, seconds ) ;
+}
+
+double ThroughputModel::estimate_read( const Glib::ustring & device_path, Byte_Value bytes )
+{
+	return estimate( get_device_key( "read", device_path ), bytes ) ;
+}
+
+//A copy can't be faster than reading the source disk
+double ThroughputModel::estimate_copy( const Glib::ustring & src_device_path,
+                                       const Glib::ustring & dst_device_path,
+                                       Byte_Value bytes )
+{
+	return std::max( estimate( get_device_key( "copy", dst_device_path ), bytes ),
+	                 estimate( get_device_key( "read", src_device_path ), bytes ) ) ;
+}
+
+double ThroughputModel::estimate_command( const Glib::ustring & action, FILESYSTEM filesystem, Byte_Value bytes )
+{
+	return estimate( action + ":" + Utils::get_filesystem_string( filesystem ), bytes ) ;
+}
+
+//Write the history to a new file which then replaces the old one, so that an
+//  interrupted write doesn't lose it.  GParted runs as root, often with the home
+//  directory of the invoking user, so nothing is written to a cache directory
+//  which the effective user doesn't own.  Called from the main thread once the
+//  operations are applied.
+void ThroughputModel::save()
+{
+	std::map<Glib::ustring, History> saved_history ;
+	{
+		Glib::Mutex::Lock lock( mutex ) ;
+		if ( ! changed )
+			return ;
+		changed = false ;
+		saved_history = history ;
+	}
+
+	Glib::ustring filename = get_filename() ;
+	std::string dirname = Glib::path_get_dirname( filename ) ;
+	if ( ! owned_by_user( dirname ) || g_mkdir_with_parents( dirname .c_str(), 0755 ) != 0 )
+		return ;
+
+	Glib::ustring temp_filename = filename + ".new" ;
+	std::ofstream file( temp_filename .c_str() ) ;
+	file .precision( 15 ) ;
+	for ( std::map<Glib::ustring, History>::const_iterator iter = saved_history .begin() ;
+	      iter != saved_history .end() ;
+	      ++iter )
+		file << iter ->first << '\t' << iter ->second .seconds << '\t'
+		     << iter ->second .bytes << '\t' << iter ->second .count << '\n' ;
+	file .close() ;
+
+	if ( file .good() )
+		std::rename( temp_filename .c_str(), filename .c_str() ) ;
+	else
+		std::remove( temp_filename .c_str() ) ;
+}
+
+//Private Methods
+void ThroughputModel::record( const Glib::ustring & key, Byte_Value bytes, double seconds )
+{
+	Glib::Mutex::Lock lock( mutex ) ;
+	load() ;
+
+	History & entry = history[ key ] ;
+	entry .seconds = entry .seconds * DECAY + seconds ;
+	entry .bytes = entry .bytes * DECAY + bytes ;
+	entry .count = entry .count * DECAY + 1 ;
+
+	changed = true ;
+}
+
+//Seconds needed for bytes, from the history of the key, or else from a default
+//  for the kind of key.  Keys without bytes are commands taking a fixed time.
+double ThroughputModel::estimate( const Glib::ustring & key, Byte_Value bytes )
+{
+	Glib::Mutex::Lock lock( mutex ) ;
+	load() ;
+
+	std::map<Glib::ustring, History>::const_iterator iter = history .find( key ) ;
+	if ( iter != history .end() )
+	{
+		if ( iter ->second .bytes > 0 )
+			return iter ->second .seconds * bytes / iter ->second .bytes ;
+		return iter ->second .seconds / iter ->second .count ;
+	}
+
+	Glib::ustring kind = key .substr( 0, key .find( ':' ) ) ;
+	Byte_Value bytes_per_second = 0 ;
+	if ( kind == "read" )
+		bytes_per_second = 100 * MEBIBYTE ;
+	else if ( kind == "copy" )
+		bytes_per_second = 40 * MEBIBYTE ;
+	else if ( kind == "check" || kind == "resize" )
+		bytes_per_second = 500 * MEBIBYTE ;
+	else if ( kind == "create" )
+		bytes_per_second = 2 * GIBIBYTE ;
+
+	return bytes_per_second > 0 ? double( bytes ) / bytes_per_second : 1 ;
+}
+
+Glib::ustring ThroughputModel::get_device_key( const Glib::ustring & kind, const Glib::ustring & device_path )
+{
+	Glib::Mutex::Lock lock( mutex ) ;
+	std::map<Glib::ustring, Glib::ustring>::const_iterator iter = device_ids .find( device_path ) ;
+	return kind + ":" + ( iter != device_ids .end() ? iter ->second : device_path ) ;
+}
+
+//Read the stored history once.  Called with the mutex held.
+void ThroughputModel::load()
+{
+	if ( loaded )
+		return ;
+	loaded = true ;
+
+	std::ifstream file( get_filename() .c_str() ) ;
+	std::string line ;
+	while ( getline( file, line ) )
+	{
+		//key <TAB> seconds <TAB> bytes <TAB> count, where the key may contain spaces
+		std::string::size_type tab_count = line .rfind( '\t' ) ;
+		std::string::size_type tab_bytes = tab_count == std::string::npos || tab_count == 0
+		                                   ? std::string::npos : line .rfind( '\t', tab_count - 1 ) ;
+		std::string::size_type tab_seconds = tab_bytes == std::string::npos || tab_bytes == 0
+		                                     ? std::string::npos : line .rfind( '\t', tab_bytes - 1 ) ;
+		if ( tab_seconds == std::string::npos || tab_seconds == 0 )
+			continue ;
+
+		History entry ;
+		entry .seconds = std::atof( line .substr( tab_seconds + 1, tab_bytes - tab_seconds - 1 ) .c_str() ) ;
+		entry .bytes = std::atof( line .substr( tab_bytes + 1, tab_count - tab_bytes - 1 ) .c_str() ) ;
+		entry .count = std::atof( line .substr( tab_count + 1 ) .c_str() ) ;
+		if ( entry .seconds > 0 && entry .count > 0 && entry .bytes >= 0 )
+			history[ line .substr( 0, tab_seconds ) ] = entry ;
+	}
+}
+
+//Whether the directory, or else the nearest of its parents which exists, belongs
+//  to the effective user
+bool ThroughputModel::owned_by_user( const std::string & path )
+{
+	std::string dirname = path ;
+	struct stat st ;
+	while ( g_stat( dirname .c_str(), &st ) != 0 )
+	{
+		std::string parent = Glib::path_get_dirname( dirname ) ;
+		if ( parent == dirname )
+			return false ;
+		dirname = parent ;
+	}
+
+	return S_ISDIR( st .st_mode ) && st .st_uid == geteuid() ;
+}
+
+Glib::ustring ThroughputModel::get_filename()
+{
+	return Glib::build_filename( Glib::get_user_cache_dir(), "gparted/throughput" ) ;
+}
+
+}//GParted
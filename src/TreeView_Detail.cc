@@ -84,18 +84,26 @@ TreeView_Detail::TreeView_Detail()
 	}
 }
 
+//Update the rows to show the partitions, only touching the rows of partitions which
+//  changed so that the scroll position survives a refresh.  As in the main window no
+//  partition is selected afterwards.
 void TreeView_Detail::load_partitions( const std::vector<Partition> & partitions ) 
 {
-	bool mountpoints = false, labels = false ;
-	treestore_detail ->clear() ;
-	
-	load_partitions( partitions, mountpoints, labels ) ;
+	bool mountpoints = false, labels = false, changed = false ;
+
+	block = true ;
+	treeselection ->unselect_all() ;
+	load_partitions( partitions, mountpoints, labels, changed ) ;
+	block = false ;
 
 	get_column( 2 ) ->set_visible( mountpoints ) ;
 	get_column( 3 ) ->set_visible( labels ) ;
 	
-	columns_autosize();
-	expand_all() ;
+	if ( changed )
+	{
+		columns_autosize();
+		expand_all() ;
+	}
 }
 
 void TreeView_Detail::set_selected( const Partition & partition )
@@ -113,16 +121,47 @@ void TreeView_Detail::clear()
 void TreeView_Detail::load_partitions( const std::vector<Partition> & partitions,
 				       bool & mountpoints,
 				       bool & labels,
+				       bool & changed,
 				       const Gtk::TreeRow & parent_row ) 
 {
+	//Both the rows and the partitions are in the order of their start sectors, so
+	//  walk them together, matching rows to partitions by identity
+	Gtk::TreeModel::Children rows = parent_row ? parent_row .children() : treestore_detail ->children() ;
+	Gtk::TreeModel::iterator iter = rows .begin() ;
+
 	Gtk::TreeRow row ;
 	for ( unsigned int i = 0 ; i < partitions .size() ; i++ ) 
 	{	
-		row = parent_row ? *( treestore_detail ->append( parent_row .children() ) ) : *( treestore_detail ->append() ) ;
-		create_row( row, partitions[ i ] );
+		//remove the rows of partitions which no longer exist
+		while ( iter != rows .end() &&
+		        static_cast<Partition>( ( *iter )[ treeview_detail_columns .partition ] ) .sector_start
+		            < partitions[ i ] .sector_start )
+		{
+			iter = treestore_detail ->erase( iter ) ;
+			changed = true ;
+		}
+
+		if ( iter != rows .end() &&
+		     static_cast<Partition>( ( *iter )[ treeview_detail_columns .partition ] ) == partitions[ i ] )
+		{
+			//reuse the row of the same partition, rewriting it only when it changed
+			row = *iter ;
+			++iter ;
+
+			if ( ! same_details( row[ treeview_detail_columns .partition ], partitions[ i ] ) )
+			{
+				create_row( row, partitions[ i ] );
+				changed = true ;
+			}
+		}
+		else
+		{
+			row = *( treestore_detail ->insert( iter ) ) ;
+			create_row( row, partitions[ i ] );
+			changed = true ;
+		}
 		
-		if ( !partitions[ i ] .logicals .empty() )
-			load_partitions( partitions[ i ] .logicals, mountpoints, labels, row ) ;
+		load_partitions( partitions[ i ] .logicals, mountpoints, labels, changed, row ) ;
 			
 		if ( partitions[ i ] .get_mountpoints() .size() )
 			mountpoints = true ;
@@ -130,6 +169,40 @@ void TreeView_Detail::load_partitions( const std::vector<Partition> & partitions
 		if ( ! partitions[ i ] .get_label() .empty() )
 			labels = true ;
 	}
+
+	//remove the rows of partitions which no longer exist
+	while ( iter != rows .end() )
+	{
+		iter = treestore_detail ->erase( iter ) ;
+		changed = true ;
+	}
+}
+
+//Return true when the two partitions are displayed identically and are the same
+//  partition, ignoring any logical partitions
+bool TreeView_Detail::same_details( const Partition & partition_a, const Partition & partition_b )
+{
+	return partition_a == partition_b                                               &&
+	       partition_a .status                == partition_b .status                &&
+	       partition_a .filesystem            == partition_b .filesystem            &&
+	       partition_a .uuid                  == partition_b .uuid                  &&
+	       partition_a .sector_end            == partition_b .sector_end            &&
+	       partition_a .sector_size           == partition_b .sector_size           &&
+	       partition_a .sectors_used          == partition_b .sectors_used          &&
+	       partition_a .sectors_unused        == partition_b .sectors_unused        &&
+	       partition_a .sectors_unallocated   == partition_b .sectors_unallocated   &&
+	       partition_a .significant_threshold == partition_b .significant_threshold &&
+	       partition_a .inside_extended       == partition_b .inside_extended       &&
+	       partition_a .busy                  == partition_b .busy                  &&
+	       partition_a .strict_start          == partition_b .strict_start          &&
+	       partition_a .free_space_before     == partition_b .free_space_before     &&
+	       partition_a .alignment             == partition_b .alignment             &&
+	       partition_a .label_known()         == partition_b .label_known()         &&
+	       partition_a .get_label()           == partition_b .get_label()           &&
+	       partition_a .get_paths()           == partition_b .get_paths()           &&
+	       partition_a .get_mountpoints()     == partition_b .get_mountpoints()     &&
+	       partition_a .messages              == partition_b .messages              &&
+	       partition_a .flags                 == partition_b .flags ;
 }
 
 bool TreeView_Detail::set_selected( Gtk::TreeModel::Children rows, const Partition & partition, bool inside_extended ) 
@@ -154,6 +227,10 @@ bool TreeView_Detail::set_selected( Gtk::TreeModel::Children rows, const Partiti
 
 void TreeView_Detail::create_row( const Gtk::TreeRow & treerow, const Partition & partition )
 {
+	//clear the icons of a reused row
+	treerow[ treeview_detail_columns .icon1 ] = Glib::RefPtr<Gdk::Pixbuf>() ;
+	treerow[ treeview_detail_columns .icon2 ] = Glib::RefPtr<Gdk::Pixbuf>() ;
+
 	if ( partition .busy )
 		treerow[ treeview_detail_columns .icon1 ] = 
 			render_icon( Gtk::Stock::DIALOG_AUTHENTICATION, Gtk::ICON_SIZE_BUTTON );
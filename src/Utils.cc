@@ -22,10 +22,15 @@
 #include <fstream>
 #include <iomanip>
 #include <glibmm/regex.h>
+#include <glibmm/thread.h>
 #include <locale.h>
 #include <uuid/uuid.h>
 #include <cerrno>
 #include <sys/statvfs.h>
+#include <sys/wait.h>
+#include <poll.h>
+#include <unistd.h>
+#include <pthread.h>
 
 
 namespace GParted
@@ -326,6 +331,82 @@ double Utils::sector_to_unit( Sector sectors, Byte_Value sector_size, SIZE_UNIT
 	}
 }
 
+//Threads applying operations in parallel take turns holding this lock, so that
+//  only one of them at a time uses libparted and the objects shared between the
+//  operations.  It is released while waiting for a command.  A thread holding it
+//  can't be cancelled, so a cancel only takes effect while a thread waits for a
+//  command or copies blocks, and never part way through changing shared state.
+static Glib::Mutex operations_mutex ;
+static Glib::Mutex operations_holder_mutex ;	//guards the three below
+static pthread_t operations_holder ;
+static bool operations_held = false ;
+static bool operations_cancelled = false ;	//no further steps may start
+
+//Take the operations lock, returning false without it when applying the
+//  operations was cancelled
+bool Utils::lock_operations()
+{
+	operations_mutex .lock() ;
+	pthread_setcancelstate( PTHREAD_CANCEL_DISABLE, NULL ) ;
+
+	{
+		Glib::Mutex::Lock lock( operations_holder_mutex ) ;
+		if ( ! operations_cancelled )
+		{
+			operations_holder = pthread_self() ;
+			operations_held = true ;
+			return true ;
+		}
+	}
+
+	pthread_setcancelstate( PTHREAD_CANCEL_ENABLE, NULL ) ;
+	operations_mutex .unlock() ;
+	return false ;
+}
+
+//Take the operations lock back after waiting for a command or copying blocks
+//  with it released.  When applying was cancelled meanwhile the thread ends here,
+//  as if it was cancelled while waiting, instead of going on with its step.
+void Utils::relock_operations()
+{
+	if ( ! lock_operations() )
+		pthread_exit( NULL ) ;
+}
+
+void Utils::unlock_operations()
+{
+	{
+		Glib::Mutex::Lock lock( operations_holder_mutex ) ;
+		operations_held = false ;
+	}
+
+	operations_mutex .unlock() ;
+	pthread_setcancelstate( PTHREAD_CANCEL_ENABLE, NULL ) ;
+}
+
+//Stop lock_operations() from handing out the lock, so that once applying the
+//  operations is cancelled no thread starts a new step
+void Utils::set_operations_cancelled( bool cancelled )
+{
+	Glib::Mutex::Lock lock( operations_holder_mutex ) ;
+	operations_cancelled = cancelled ;
+}
+
+//Release the operations lock if the calling thread holds it, returning whether
+//  it did.  Once the calling thread is known to be the holder, no other thread
+//  changes the holder until it unlocks.
+bool Utils::release_operations_lock()
+{
+	{
+		Glib::Mutex::Lock lock( operations_holder_mutex ) ;
+		if ( ! operations_held || ! pthread_equal( operations_holder, pthread_self() ) )
+			return false ;
+	}
+
+	unlock_operations() ;
+	return true ;
+}
+
 int Utils::execute_command( const Glib::ustring & command )
 {
 	Glib::ustring dummy ;
@@ -340,6 +421,9 @@ int Utils::execute_command( const Glib::ustring & command,
 	int exit_status = -1 ;
 	std::string std_out, std_error ;
 
+	//output and error may belong to an object shared with other operations, so
+	//  only store into them once the operations lock is held again
+	bool released = release_operations_lock() ;
 	try
 	{
 		std::vector<std::string>argv;
@@ -379,17 +463,221 @@ int Utils::execute_command( const Glib::ustring & command,
 	}
 	catch ( Glib::Exception & e )
 	{
-		 error = e .what() ;
+		 std::string message = e .what() ;
+		 if ( released )
+			 relock_operations() ;
+		 error = message ;
 
 		 return -1 ;
 	}
 
+	if ( released )
+		relock_operations() ;
 	output = Utils::cleanup_cursor( std_out ) ;
 	error = std_error ;
 
 	return exit_status ;
 }
 
+//Output of a streamed command kept in memory.  Once a stream grows beyond the
+//  head plus twice the tail, the lines in between are dropped.
+const std::string::size_type STREAM_HEAD_BYTES = 1024 * 1024 ;
+const std::string::size_type STREAM_TAIL_BYTES = 1024 * 1024 ;
+
+struct CommandStream
+{
+	CommandStream() : fd( -1 ), startofline( 0 ), head_end( 0 ), pending_cr( false ) {}
+
+	int fd ;
+	std::string text ;
+	std::string::size_type startofline ;
+	std::string::size_type head_end ;	//0 until lines have been dropped
+	bool pending_cr ;
+} ;
+
+//Append data read from a command to its stream, applying carriage returns and
+//  backspaces as cleanup_cursor() does, so that redrawn progress bars don't
+//  accumulate.  Every line is passed to slot_progress when it is completed or
+//  redrawn, and the unfinished last line once all data is added.
+static void add_stream_data( CommandStream & stream,
+                             const char * data,
+                             ssize_t count,
+                             const sigc::slot<void, const std::string &> & slot_progress )
+{
+	for ( ssize_t i = 0 ; i < count ; i ++ )
+	{
+		char ch = data[ i ] ;
+		if ( stream .pending_cr )
+		{
+			stream .pending_cr = false ;
+			if ( ch == '\n' )
+				stream .text += '\r' ;		//windows CRLF
+			else
+				stream .text .resize( stream .startofline ) ;
+		}
+
+		switch ( ch )
+		{
+			case '\r':
+				slot_progress( stream .text .substr( stream .startofline ) ) ;
+				stream .pending_cr = true ;
+				break ;
+			case '\b':
+				if ( stream .text .size() > stream .startofline )
+					stream .text .resize( stream .text .size() - 1 ) ;
+				break ;
+			case '\n':
+				slot_progress( stream .text .substr( stream .startofline ) ) ;
+				stream .text += ch ;
+				stream .startofline = stream .text .size() ;
+
+				if ( stream .text .size() > STREAM_HEAD_BYTES + 2 * STREAM_TAIL_BYTES )
+				{
+					if ( ! stream .head_end )
+					{
+						stream .head_end = stream .text .rfind( '\n', STREAM_HEAD_BYTES ) + 1 ;
+						stream .text .insert( stream .head_end, "[...]\n" ) ;
+						stream .head_end += 6 ;
+					}
+					std::string::size_type cut = stream .text .find(
+						'\n', stream .text .size() - STREAM_TAIL_BYTES ) + 1 ;
+					stream .text .erase( stream .head_end, cut - stream .head_end ) ;
+					stream .startofline = stream .text .size() ;
+				}
+				break ;
+			default:
+				stream .text += ch ;
+		}
+	}
+
+	if ( ! stream .pending_cr && stream .text .size() > stream .startofline )
+		slot_progress( stream .text .substr( stream .startofline ) ) ;
+}
+
+//Run a command like execute_command(), but read its output while it runs and
+//  hand every line to slot_progress, so the caller can report the progress
+//  printed by the command.  Called from the operation thread.
+int Utils::execute_command_streamed( const Glib::ustring & command,
+                                     Glib::ustring & output,
+                                     Glib::ustring & error,
+                                     const sigc::slot<void, const std::string &> & slot_progress,
+                                     bool use_C_locale )
+{
+	Glib::Pid pid ;
+	CommandStream streams[ 2 ] ;
+
+	bool released = release_operations_lock() ;
+	try
+	{
+		std::vector<std::string>argv;
+		argv .push_back( "sh" ) ;
+		argv .push_back( "-c" ) ;
+		argv .push_back( command ) ;
+
+		if ( use_C_locale )
+		{
+			//Spawn command using the C language environment
+			std::vector<std::string> envp ;
+			envp .push_back( "LC_ALL=C" ) ;
+			envp .push_back( "PATH=" + Glib::getenv( "PATH" ) ) ;
+
+			Glib::spawn_async_with_pipes( "."
+			                            , argv
+			                            , envp
+			                            , Glib::SPAWN_SEARCH_PATH | Glib::SPAWN_DO_NOT_REAP_CHILD
+			                            , sigc::slot<void>()
+			                            , &pid
+			                            , NULL
+			                            , &streams[ 0 ] .fd
+			                            , &streams[ 1 ] .fd
+			                            ) ;
+		}
+		else
+		{
+			//Spawn command inheriting the parent's environment
+			Glib::spawn_async_with_pipes( "."
+			                            , argv
+			                            , Glib::SPAWN_SEARCH_PATH | Glib::SPAWN_DO_NOT_REAP_CHILD
+			                            , sigc::slot<void>()
+			                            , &pid
+			                            , NULL
+			                            , &streams[ 0 ] .fd
+			                            , &streams[ 1 ] .fd
+			                            ) ;
+		}
+	}
+	catch ( Glib::Exception & e )
+	{
+		 std::string message = e .what() ;
+		 if ( released )
+			 relock_operations() ;
+		 error = message ;
+
+		 return -1 ;
+	}
+
+	//Read stdout and stderr as data arrives, until the command closes both
+	char buf[ 4096 ] ;
+	while ( streams[ 0 ] .fd >= 0 || streams[ 1 ] .fd >= 0 )
+	{
+		struct pollfd fds[ 2 ] ;
+		int index[ 2 ] ;
+		nfds_t nfds = 0 ;
+		for ( int t = 0 ; t < 2 ; t ++ )
+			if ( streams[ t ] .fd >= 0 )
+			{
+				fds[ nfds ] .fd = streams[ t ] .fd ;
+				fds[ nfds ] .events = POLLIN ;
+				fds[ nfds ] .revents = 0 ;
+				index[ nfds ++ ] = t ;
+			}
+
+		if ( poll( fds, nfds, -1 ) < 0 )
+		{
+			if ( errno == EINTR )
+				continue ;
+			for ( int t = 0 ; t < 2 ; t ++ )
+				if ( streams[ t ] .fd >= 0 )
+				{
+					close( streams[ t ] .fd ) ;
+					streams[ t ] .fd = -1 ;
+				}
+			break ;
+		}
+
+		for ( nfds_t t = 0 ; t < nfds ; t ++ )
+		{
+			if ( ! fds[ t ] .revents )
+				continue ;
+
+			CommandStream & stream = streams[ index[ t ] ] ;
+			ssize_t count = read( stream .fd, buf, sizeof( buf ) ) ;
+			if ( count > 0 )
+				add_stream_data( stream, buf, count, slot_progress ) ;
+			else if ( count == 0 || errno != EINTR )
+			{
+				close( stream .fd ) ;
+				stream .fd = -1 ;
+			}
+		}
+	}
+
+	int exit_status = -1 ;
+	while ( waitpid( pid, &exit_status, 0 ) < 0 && errno == EINTR ) {}
+	Glib::spawn_close_pid( pid ) ;
+
+	for ( int t = 0 ; t < 2 ; t ++ )
+		if ( streams[ t ] .pending_cr )
+			streams[ t ] .text .resize( streams[ t ] .startofline ) ;
+
+	if ( released )
+		relock_operations() ;
+	output = streams[ 0 ] .text ;
+	error = streams[ 1 ] .text ;
+
+	return exit_status ;
+}
+
 Glib::ustring Utils::regexp_label( const Glib::ustring & text
                                  , const Glib::ustring & pattern
                                  )
@@ -35,7 +35,9 @@
 #include "../include/OperationResizeMove.h"
 #include "../include/OperationChangeUUID.h"
 #include "../include/OperationLabelPartition.h"
+#include "../include/OperationPlanner.h"
 #include "../include/LVM2_PV_Info.h"
+#include "../include/ThroughputModel.h"
 #include "../config.h"
 
 #include <gtkmm/aboutdialog.h>
@@ -43,9 +45,15 @@
 #include <gtkmm/radiobuttongroup.h>
 #include <gtkmm/main.h>
 #include <gtkmm/separator.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 namespace GParted
 {
+
+//Number of queued operations between kept partition layout snapshots
+static const int VISUAL_SNAPSHOT_INTERVAL = 8 ;
 	
 Win_GParted::Win_GParted( const std::vector<Glib::ustring> & user_devices )
 {
@@ -53,6 +61,9 @@ Win_GParted::Win_GParted( const std::vector<Glib::ustring> & user_devices )
 	selected_partition .Reset() ;
 	new_count = 1;
 	pulse = false ; 
+	showing_scanned_devices = false ;
+	prefetch_thread = NULL ;
+	prefetch_stop = prefetch_done = false ;
 	OPERATIONSLIST_OPEN = true ;
 	gparted_core .set_user_devices( user_devices ) ;
 	
@@ -615,7 +626,7 @@ void Win_GParted::refresh_combo_devices( unsigned int current_device )
 	combo_devices .set_active( current_device ) ;
 }
 
-void Win_GParted::show_pulsebar( const Glib::ustring & status_message ) 
+void Win_GParted::show_pulsebar( const Glib::ustring & status_message, const sigc::slot<void> & slot_pulse ) 
 {
 	pulsebar .show();
 	statusbar .push( status_message) ;
@@ -640,6 +651,8 @@ void Win_GParted::show_pulsebar( const Glib::ustring & status_message )
 		Glib::ustring tmp_msg = gparted_core .get_thread_status_message() ;
 		if ( tmp_msg != "" )
 			statusbar .push( tmp_msg ) ;
+		if ( ! slot_pulse .empty() )
+			slot_pulse() ;
 	}
 	
 	thread ->join() ;
@@ -676,7 +689,11 @@ void Win_GParted::Fill_Label_Device_Info()
 
 bool Win_GParted::on_delete_event( GdkEventAny *event )
 {
-	return ! Quit_Check_Operations();
+	if ( ! Quit_Check_Operations() )
+		return true ;
+
+	stop_prefetch() ;
+	return false ;
 }	
 
 void Win_GParted::Add_Operation( Operation * operation, int index )
@@ -747,6 +764,7 @@ bool Win_GParted::Merge_Operations( unsigned int first, unsigned int second )
 	{
 		operations[ first ]->partition_new = operations[ second ]->partition_new;
 		operations[ first ]->create_description() ;
+		invalidate_visual_snapshots( first ) ;
 		remove_operation( second );
 
 		Refresh_Visual();
@@ -761,6 +779,7 @@ bool Win_GParted::Merge_Operations( unsigned int first, unsigned int second )
 	{
 		operations[ first ]->partition_new.set_label( operations[ second ]->partition_new .get_label() ) ;
 		operations[ first ]->create_description() ;
+		invalidate_visual_snapshots( first ) ;
 		remove_operation( second );
 
 		Refresh_Visual();
@@ -778,6 +797,7 @@ bool Win_GParted::Merge_Operations( unsigned int first, unsigned int second )
 		     operations[ second ]->partition_new.uuid == UUID_RANDOM )
 			operations[ first ]->partition_new.uuid = operations[ second ]->partition_new.uuid;
 		operations[ first ]->create_description() ;
+		invalidate_visual_snapshots( first ) ;
 		remove_operation( second );
 
 		Refresh_Visual();
@@ -804,6 +824,7 @@ bool Win_GParted::Merge_Operations( unsigned int first, unsigned int second )
 	{
 		operations[ first ]->partition_new = operations[ second ]->partition_new;
 		operations[ first ]->create_description() ;
+		invalidate_visual_snapshots( first ) ;
 		remove_operation( second );
 
 		Refresh_Visual();
@@ -816,27 +837,70 @@ bool Win_GParted::Merge_Operations( unsigned int first, unsigned int second )
 
 void Win_GParted::Refresh_Visual()
 {
-	//no partition can be selected after a refresh..
+	//the selected partition is selected again below, if it still exists
+	Partition previous_selected_partition = selected_partition ;
 	selected_partition .Reset() ;
 
-	std::vector<Partition> partitions = get_selected_device() .partitions ;
-	
-	//make all operations visible
-	for ( unsigned int t = 0 ; t < operations .size(); t++ )
-		if ( operations[ t ] ->device == get_selected_device() )
-			operations[ t ] ->apply_to_visual( partitions ) ;
+	if ( visual_device_path != get_selected_device() .get_path() )
+	{
+		invalidate_visual_snapshots( 0 ) ;
+		visual_device_path = get_selected_device() .get_path() ;
+	}
+
+	//keep the snapshots of the unchanged head of the queue
+	unsigned int valid = 0 ;
+	while ( valid < visual_operations .size() &&
+	        valid < operations .size() &&
+	        visual_operations[ valid ] == operations[ valid ] )
+		valid++ ;
+	invalidate_visual_snapshots( valid ) ;
+
+	//make all operations visible, replaying only those after the last snapshot.  The
+	//  latest snapshot is moved along, unless it is a few operations past the one
+	//  before, in which case it is kept and a new one started.
+	valid = visual_snapshots .empty() ? 0 : visual_snapshots .back() .first + 1 ;
+	visual_operations .resize( valid ) ;
+	for ( unsigned int t = valid ; t < operations .size() ; t++ )
+	{
+		visual_operations .push_back( operations[ t ] ) ;
+		if ( ! ( operations[ t ] ->device == get_selected_device() ) )
+			continue ;
+
+		int previous = visual_snapshots .size() >= 2 ? visual_snapshots[ visual_snapshots .size() -2 ] .first : -1 ;
+		if ( visual_snapshots .empty() )
+			visual_snapshots .push_back( std::make_pair( t, get_selected_device() .partitions ) ) ;
+		else if ( static_cast<int>( visual_snapshots .back() .first ) - previous >= VISUAL_SNAPSHOT_INTERVAL )
+			visual_snapshots .push_back( std::make_pair( t, visual_snapshots .back() .second ) ) ;
+		else
+			visual_snapshots .back() .first = t ;
+		operations[ t ] ->apply_to_visual( visual_snapshots .back() .second ) ;
+	}
+
+	const std::vector<Partition> & partitions = visual_snapshots .empty() ? get_selected_device() .partitions
+	                                                                      : visual_snapshots .back() .second ;
 			
-	hbox_operations .load_operations( operations ) ;
+	std::vector<double> durations ;
+	double total_duration = 0 ;
+	for ( unsigned int t = 0 ; t < operations .size() ; t++ )
+	{
+		durations .push_back( GParted_Core::estimate_duration( operations[ t ] ) ) ;
+		total_duration += durations .back() ;
+	}
+	hbox_operations .load_operations( operations, durations ) ;
 
 	//set new statusbartext
+	Glib::ustring status = String::ucompose( ngettext( "%1 operation pending"
+	                                                 , "%1 operations pending"
+	                                                 , operations .size()
+	                                                 )
+	                                       , operations .size()
+	                                       ) ;
+	if ( operations .size() )
+		/*TO TRANSLATORS: looks like  3 operations pending, estimated time at most 00:12:30 */
+		status = String::ucompose( _("%1, estimated time at most %2"),
+		                           status, Utils::format_time( Utils::round( total_duration ) ) ) ;
 	statusbar .pop() ;
-	statusbar .push( String::ucompose( ngettext( "%1 operation pending"
-	                                           , "%1 operations pending"
-	                                           , operations .size()
-	                                           )
-	                                 , operations .size()
-	                                 )
-	               );
+	statusbar .push( status ) ;
 		
 	if ( ! operations .size() ) 
 		allow_undo_clear_apply( false ) ;
@@ -871,6 +935,21 @@ void Win_GParted::Refresh_Visual()
 	//treeview details
 	treeview_detail .load_partitions( partitions ) ;
 
+	for ( unsigned int t = 0 ; t < partitions .size() ; t++ )
+	{
+		if ( partitions[ t ] == previous_selected_partition )
+			selected_partition = partitions[ t ] ;
+
+		for ( unsigned int i = 0 ; i < partitions[ t ] .logicals .size() ; i++ )
+			if ( partitions[ t ] .logicals[ i ] == previous_selected_partition )
+				selected_partition = partitions[ t ] .logicals[ i ] ;
+	}
+	if ( selected_partition .get_paths() .size() )
+	{
+		drawingarea_visualdisk .set_selected( selected_partition ) ;
+		treeview_detail .set_selected( selected_partition ) ;
+	}
+
 	set_valid_operations() ; 
 			
 	while ( Gtk::Main::events_pending() ) 
@@ -1172,6 +1251,8 @@ void Win_GParted::combo_devices_changed()
 	}
 	set_title( String::ucompose( _("%1 - GParted"), devices[ current_device ] .get_path() ) );
 
+	read_selected_device_details() ;
+
 	//No partition is selected any more
 	selected_partition .Reset() ;
 
@@ -1208,19 +1289,209 @@ void Win_GParted::on_show()
 	menu_gparted_refresh_devices() ;
 }
 	
-void Win_GParted::thread_refresh_devices() 
+void Win_GParted::thread_refresh_devices( Glib::ustring first_device_path ) 
 {
-	gparted_core .set_devices( devices ) ;
+	gparted_core .set_devices( scanned_devices, first_device_path ) ;
 	pulse = false ;
 }
 
+//Show the devices scanned so far, while the scan continues.  Only selecting a
+//  device is possible until all devices are scanned.
+void Win_GParted::add_scanned_devices()
+{
+	std::vector<Device> new_devices ;
+	gparted_core .get_scanned_devices( new_devices ) ;
+	if ( new_devices .empty() )
+		return ;
+
+	Glib::ustring selected_path ;
+	unsigned int current_device = combo_devices .get_active_row_number() ;
+	if ( showing_scanned_devices && current_device < devices .size() )
+		selected_path = devices[ current_device ] .get_path() ;
+	else
+	{
+		//replace the devices found by the previous scan
+		devices .clear() ;
+		showing_scanned_devices = true ;
+	}
+
+	for ( unsigned int t = 0 ; t < new_devices .size() ; t++ )
+	{
+		unsigned int i ;
+		for ( i = 0 ; i < devices .size() && devices[ i ] .get_path() < new_devices[ t ] .get_path() ; i++ ) {}
+		devices .insert( devices .begin() + i, new_devices[ t ] ) ;
+	}
+
+	//the first device scanned is the one shown before the refresh
+	if ( selected_path .empty() )
+		selected_path = new_devices .front() .get_path() ;
+
+	for ( current_device = 0 ; current_device < devices .size() && devices[ current_device ] .get_path() != selected_path ; current_device++ ) {}
+
+	invalidate_visual_snapshots( 0 ) ;
+	combo_devices .show() ;
+	combo_devices .set_sensitive( true ) ;
+	refresh_combo_devices( current_device ) ;
+}
+
+void Win_GParted::thread_read_device_details( Glib::ustring device_path, bool * success )
+{
+	*success = GParted_Core::parse_device( device_path, detailed_device ) ;
+	pulse = false ;
+}
+
+//The device scan only reads the selected device in detail.  Read the labels, UUIDs
+//  and usage of another device when it is selected, unless the prefetch thread
+//  already did.
+void Win_GParted::read_selected_device_details()
+{
+	unsigned int current_device = combo_devices .get_active_row_number() ;
+	if ( pulse || current_device >= devices .size() || devices[ current_device ] .details_known )
+		return ;
+
+	bool success = false ;
+	stop_prefetch() ;
+	if ( devices[ current_device ] .details_known )
+		return ;
+
+	pulse = true ;
+	thread = Glib::Thread::create( sigc::bind<Glib::ustring, bool *>(
+			sigc::mem_fun( *this, &Win_GParted::thread_read_device_details ),
+			devices[ current_device ] .get_path(), &success ), true ) ;
+
+	/*TO TRANSLATORS: looks like   Searching /dev/sda partitions */
+	show_pulsebar( String::ucompose( _("Searching %1 partitions"), devices[ current_device ] .get_path() ) ) ;
+
+	if ( success )
+	{
+		devices[ current_device ] = detailed_device ;
+		invalidate_visual_snapshots( 0 ) ;
+	}
+	detailed_device .Reset() ;
+
+	start_prefetch() ;
+}
+
+//Read the devices which are not yet known in detail in a background thread at
+//  low priority, one at a time, so they are complete by the time they are
+//  selected.  The thread is stopped before anything else uses GParted_Core.
+void Win_GParted::thread_prefetch_device_details( std::vector<Glib::ustring> device_paths )
+{
+	//file system programs run by this thread inherit its nice value
+	setpriority( PRIO_PROCESS, syscall( SYS_gettid ), 19 ) ;
+
+	for ( unsigned int t = 0 ; t < device_paths .size() && ! prefetch_stop ; t++ )
+	{
+		Device temp_device ;
+		if ( GParted_Core::parse_device( device_paths[ t ], temp_device ) )
+		{
+			Glib::Mutex::Lock lock( prefetch_mutex ) ;
+			prefetched_devices .push_back( temp_device ) ;
+		}
+	}
+
+	Glib::Mutex::Lock lock( prefetch_mutex ) ;
+	prefetch_done = true ;
+}
+
+void Win_GParted::start_prefetch()
+{
+	if ( prefetch_thread || pulse )
+		return ;
+
+	std::vector<Glib::ustring> device_paths ;
+	for ( unsigned int t = 0 ; t < devices .size() ; t++ )
+		if ( ! devices[ t ] .details_known )
+			device_paths .push_back( devices[ t ] .get_path() ) ;
+	if ( device_paths .empty() )
+		return ;
+
+	prefetch_stop = prefetch_done = false ;
+	prefetch_thread = Glib::Thread::create( sigc::bind(
+			sigc::mem_fun( *this, &Win_GParted::thread_prefetch_device_details ), device_paths ), true ) ;
+	prefetch_connection = Glib::signal_timeout() .connect(
+			sigc::mem_fun( *this, &Win_GParted::merge_prefetched_devices ), 500 ) ;
+}
+
+//Wait for the device being read by the prefetch thread and keep what it has read
+void Win_GParted::stop_prefetch()
+{
+	if ( ! prefetch_thread )
+		return ;
+
+	prefetch_stop = true ;
+	prefetch_thread ->join() ;
+	prefetch_done = true ;
+	merge_prefetched_devices() ;
+}
+
+bool Win_GParted::merge_prefetched_devices()
+{
+	std::vector<Device> new_devices ;
+	bool done ;
+	{
+		Glib::Mutex::Lock lock( prefetch_mutex ) ;
+		new_devices .swap( prefetched_devices ) ;
+		done = prefetch_done ;
+	}
+
+	//a device which changed since, e.g. by a rescan, keeps its own information
+	for ( unsigned int t = 0 ; t < new_devices .size() ; t++ )
+		for ( unsigned int i = 0 ; i < devices .size() ; i++ )
+			if ( ! devices[ i ] .details_known && devices[ i ] .get_path() == new_devices[ t ] .get_path() )
+			{
+				devices[ i ] = new_devices[ t ] ;
+				if ( static_cast<int>( i ) == combo_devices .get_active_row_number() )
+				{
+					invalidate_visual_snapshots( 0 ) ;
+					Fill_Label_Device_Info() ;
+					Refresh_Visual() ;
+				}
+			}
+
+	//stopped while merging
+	if ( ! prefetch_thread )
+		return false ;
+
+	if ( ! done )
+		return true ;
+
+	if ( ! prefetch_stop )
+		prefetch_thread ->join() ;
+	prefetch_thread = NULL ;
+	prefetch_connection .disconnect() ;
+	return false ;
+}
+
 void Win_GParted::menu_gparted_refresh_devices()
 {
+	stop_prefetch() ;
 	pulse = true ;	
 	unsigned int current_device = combo_devices .get_active_row_number() ;
-	thread = Glib::Thread::create( sigc::mem_fun( *this, &Win_GParted::thread_refresh_devices ), true ) ;
+	Glib::ustring selected_path ;
+	if ( current_device < devices .size() )
+		selected_path = devices[ current_device ] .get_path() ;
+
+	showing_scanned_devices = false ;
+	thread = Glib::Thread::create( sigc::bind(
+			sigc::mem_fun( *this, &Win_GParted::thread_refresh_devices ), selected_path ), true ) ;
+
+	show_pulsebar( _("Scanning all devices..."),
+	               sigc::mem_fun( *this, &Win_GParted::add_scanned_devices ) ) ;
 
-	show_pulsebar( _("Scanning all devices...") ) ;
+	//keep showing the device selected while scanning
+	current_device = combo_devices .get_active_row_number() ;
+	if ( showing_scanned_devices && current_device < devices .size() )
+		selected_path = devices[ current_device ] .get_path() ;
+
+	devices .swap( scanned_devices ) ;
+	scanned_devices .clear() ;
+	showing_scanned_devices = false ;
+
+	for ( current_device = 0 ; current_device < devices .size() && devices[ current_device ] .get_path() != selected_path ; current_device++ ) {}
+
+	//the devices have been rescanned so the cached partition layouts are stale
+	invalidate_visual_snapshots( 0 ) ;
 
 	//see if there are any pending operations on non-existent devices
 	//NOTE that this isn't 100% foolproof since some stuff (e.g. sourcedevice of copy) may slip through.
@@ -1280,6 +1551,8 @@ void Win_GParted::menu_gparted_refresh_devices()
 
 		refresh_combo_devices( current_device ) ;
 	}
+
+	start_prefetch() ;
 }
 
 void Win_GParted::menu_gparted_features()
@@ -1290,6 +1563,7 @@ void Win_GParted::menu_gparted_features()
 	dialog .load_filesystems( gparted_core .get_filesystems() ) ;
 	while ( dialog .run() == Gtk::RESPONSE_OK )
 	{
+		stop_prefetch() ;
 		gparted_core .find_supported_filesystems() ;
 		dialog .load_filesystems( gparted_core .get_filesystems() ) ;
 
@@ -1298,12 +1572,17 @@ void Win_GParted::menu_gparted_features()
 		menu_partition .items()[ MENU_FORMAT ] .set_submenu( * create_format_menu() ) ;
 		menu_partition .items()[ MENU_FORMAT ] .get_submenu() ->show_all_children() ;
 	}
+
+	start_prefetch() ;
 }
 
 void Win_GParted::menu_gparted_quit()
 {
 	if ( Quit_Check_Operations() )
+	{
+		stop_prefetch() ;
 		this ->hide();
+	}
 }
 
 void Win_GParted::menu_view_harddisk_info()
@@ -2144,6 +2423,7 @@ void Win_GParted::toggle_busy_state()
 	bool succes = false ;
 	Glib::ustring error ;
 
+	stop_prefetch() ;
 	pulse = true ;
 
 	if ( selected_partition .filesystem == GParted::FS_LINUX_SWAP )
@@ -2283,6 +2563,7 @@ void Win_GParted::activate_mount_partition( unsigned int index )
 	bool succes = false ;
 	Glib::ustring error ;
 
+	stop_prefetch() ;
 	pulse = true ;
 
 	thread = Glib::Thread::create( sigc::bind<Glib::ustring, bool *, Glib::ustring *>( 
@@ -2377,6 +2658,8 @@ void Win_GParted::activate_disklabel()
 		return ;
 	}
 
+	stop_prefetch() ;
+
 	//Display dialog for creating a new partition table.
 	Dialog_Disklabel dialog( get_selected_device() .get_path(), gparted_core .get_disklabeltypes() ) ;
 	dialog .set_transient_for( *this );
@@ -2398,6 +2681,8 @@ void Win_GParted::activate_disklabel()
 			
 		menu_gparted_refresh_devices() ;
 	}
+	else
+		start_prefetch() ;
 }
 
 //Runs when the Device->Attempt Rescue Data is clicked
@@ -2435,6 +2720,7 @@ void Win_GParted::activate_attempt_rescue_data()
 
 	messageDialog.hide();
 
+	stop_prefetch() ;
 	pulse=true;
 	this->thread = Glib::Thread::create( sigc::mem_fun( *this, &Win_GParted::thread_guess_partition_table ), true ) ;
 
@@ -2457,6 +2743,7 @@ void Win_GParted::activate_attempt_rescue_data()
 		errorDialog.set_secondary_text(_("The disk scan by gpart did not find any recognizable file systems on this disk."));
 
 		errorDialog.run();
+		start_prefetch() ;
 		return;
 	}
 
@@ -2476,6 +2763,7 @@ void Win_GParted::activate_manage_flags()
 	while ( Gtk::Main::events_pending() )
 		Gtk::Main::iteration() ;
 
+	stop_prefetch() ;
 	DialogManageFlags dialog( selected_partition, gparted_core .get_available_flags( selected_partition ) ) ;
 	dialog .set_transient_for( *this ) ;
 	dialog .signal_get_flags .connect(
@@ -2490,6 +2778,8 @@ void Win_GParted::activate_manage_flags()
 	
 	if ( dialog .any_change )
 		menu_gparted_refresh_devices() ;
+	else
+		start_prefetch() ;
 }
 	
 void Win_GParted::activate_check() 
@@ -2615,6 +2905,15 @@ void Win_GParted::activate_undo()
 
 void Win_GParted::remove_operation( int index, bool remove_all ) 
 {
+	//the snapshots from the removed operation onwards are stale, and a later
+	//  operation may be allocated at the address of the removed one
+	if ( remove_all )
+		invalidate_visual_snapshots( 0 ) ;
+	else if ( index == -1 && operations .size() > 0 )
+		invalidate_visual_snapshots( operations .size() - 1 ) ;
+	else if ( index > -1 )
+		invalidate_visual_snapshots( index ) ;
+
 	if ( remove_all )
 	{
 		for ( unsigned int t = 0 ; t < operations .size() ; t++ )
@@ -2634,6 +2933,14 @@ void Win_GParted::remove_operation( int index, bool remove_all )
 	}
 }
 
+void Win_GParted::invalidate_visual_snapshots( unsigned int index )
+{
+	if ( index < visual_operations .size() )
+		visual_operations .resize( index ) ;
+	while ( ! visual_snapshots .empty() && visual_snapshots .back() .first >= index )
+		visual_snapshots .pop_back() ;
+}
+
 int Win_GParted::partition_in_operation_queue_count( const Partition & partition )
 {
 	int operation_count = 0 ;
@@ -2691,6 +2998,26 @@ void Win_GParted::activate_apply()
 	temp =  _( "Editing partitions has the potential to cause LOSS of DATA.") ;
 	temp += "\n" ;
 	temp += _( "You are advised to backup your data before proceeding." ) ;
+
+	//look for an equivalent way to apply the operations which moves less data
+	OperationPlanner planner( operations ) ;
+	bool optimized = planner .optimize() ;
+	if ( optimized )
+	{
+		temp += "\n\n" ;
+		if ( planner .get_planned_bytes() < planner .get_queued_bytes() )
+			/*TO TRANSLATORS: looks like   The operations will be applied in an equivalent order which moves 2.1 GiB of data instead of 9.8 GiB. */
+			temp += String::ucompose( _("The operations will be applied in an equivalent order which moves %1 of data instead of %2."),
+			                          Utils::format_size( planner .get_planned_bytes(), 1 ),
+			                          Utils::format_size( planner .get_queued_bytes(), 1 ) ) ;
+		else
+			temp += String::ucompose( ngettext( "The operations will be applied in an equivalent order with %1 operation less."
+			                                  , "The operations will be applied in an equivalent order with %1 operations less."
+			                                  , planner .get_removed_operations()
+			                                  )
+			                        , planner .get_removed_operations()
+			                        ) ;
+	}
 	dialog .set_secondary_text( temp ) ;
 	dialog .set_title( _( "Apply operations to device" ) );
 	
@@ -2701,13 +3028,25 @@ void Win_GParted::activate_apply()
 	if ( dialog.run() == Gtk::RESPONSE_OK )
 	{
 		dialog .hide() ; //hide confirmationdialog
+		stop_prefetch() ;
+
+		if ( optimized )
+		{
+			//the visual snapshots refer to the operations as queued
+			invalidate_visual_snapshots( 0 ) ;
+			planner .apply( operations ) ;
+		}
 		
 		Dialog_Progress dialog_progress( operations ) ;
 		dialog_progress .set_transient_for( *this ) ;
-		dialog_progress .signal_apply_operation .connect(
-			sigc::mem_fun(gparted_core, &GParted_Core::apply_operation_to_disk) ) ;
+		dialog_progress .signal_apply_operations .connect(
+			sigc::mem_fun(gparted_core, &GParted_Core::apply_operations_to_disk) ) ;
 		dialog_progress .signal_get_libparted_version .connect(
 			sigc::mem_fun(gparted_core, &GParted_Core::get_libparted_version) ) ;
+		dialog_progress .signal_estimate_duration .connect(
+			sigc::ptr_fun( &GParted_Core::estimate_duration ) ) ;
+		dialog_progress .signal_close_partition_tables .connect(
+			sigc::ptr_fun( &GParted_Core::close_held_partition_tables ) ) ;
  
 		int response ;
 		do
@@ -2717,6 +3056,9 @@ void Win_GParted::activate_apply()
 		while ( response == Gtk::RESPONSE_CANCEL || response == Gtk::RESPONSE_OK ) ;
 		
 		dialog_progress .hide() ;
+
+		//keep the measurements of the applied operations for later estimates
+		ThroughputModel::save() ;
 		
 		//wipe operations...
 		remove_operation( -1, true ) ;
@@ -2867,6 +3209,7 @@ Device& Win_GParted::get_selected_device()
 	//they are not added to the devices list by GPartedCore. This does not have any adversary effects.
 	//It's just not very beautiful.
 
+	stop_prefetch() ;
 	Device dev ;
 	GParted_Core::parse_device( selected_partition .device_path, dev ) ;
 	devices.push_back( dev );
@@ -122,9 +122,9 @@ bool btrfs::check_repair( const Partition & partition, OperationDetail & operati
 void btrfs::set_used_sectors( Partition & partition )
 {
 	if ( btrfs_found )
-		exit_status = Utils::execute_command( "btrfs filesystem show " + partition .get_path(), output, error, true ) ;
+		exit_status = execute_probe_command( "btrfs filesystem show " + partition .get_path(), true ) ;
 	else
-		exit_status = Utils::execute_command( "btrfs-show " + partition .get_path(), output, error, true ) ;
+		exit_status = execute_probe_command( "btrfs-show " + partition .get_path(), true ) ;
 	if ( ! exit_status )
 	{
 		//FIXME: Improve free space calculation for multi-device
@@ -247,7 +247,7 @@ void btrfs::read_label( Partition & partition )
 {
 	if ( btrfs_found )
 	{
-		exit_status = Utils::execute_command( "btrfs filesystem show " + partition .get_path(), output, error, true ) ;
+		exit_status = execute_probe_command( "btrfs filesystem show " + partition .get_path(), true ) ;
 		if ( ! exit_status )
 		{
 			partition .set_label( Utils::regexp_label( output, "^Label: '(.*)'  uuid:" ) ) ;
@@ -261,7 +261,7 @@ void btrfs::read_label( Partition & partition )
 	}
 	else
 	{
-		exit_status = Utils::execute_command( "btrfs-show " + partition .get_path(), output, error, true ) ;
+		exit_status = execute_probe_command( "btrfs-show " + partition .get_path(), true ) ;
 		if ( ! exit_status )
 		{
 			Glib::ustring label = Utils::regexp_label( output, "^Label: (.*)  uuid:" ) ;
@@ -288,7 +288,7 @@ void btrfs::read_uuid( Partition & partition )
 {
 	if ( btrfs_found )
 	{
-		exit_status = Utils::execute_command( "btrfs filesystem show " + partition .get_path(), output, error, true ) ;
+		exit_status = execute_probe_command( "btrfs filesystem show " + partition .get_path(), true ) ;
 		if ( ! exit_status )
 		{
 			partition .uuid = Utils::regexp_label( output, "uuid:[[:blank:]]*(" RFC4122_NONE_NIL_UUID_REGEXP ")" ) ;
@@ -296,7 +296,7 @@ void btrfs::read_uuid( Partition & partition )
 	}
 	else
 	{
-		exit_status = Utils::execute_command( "btrfs-show " + partition .get_path(), output, error, true ) ;
+		exit_status = execute_probe_command( "btrfs-show " + partition .get_path(), true ) ;
 		if ( ! exit_status )
 		{
 			partition .uuid = Utils::regexp_label( output, "uuid:[[:blank:]]*(" RFC4122_NONE_NIL_UUID_REGEXP ")" ) ;
@@ -72,7 +72,7 @@ void ext3::set_used_sectors( Partition & partition )
 	//  avoid overhead subtraction.  Read the free space from the kernel via
 	//  the statvfs() system call when mounted and from the superblock when
 	//  unmounted.
-	if ( ! Utils::execute_command( "dumpe2fs -h " + partition .get_path(), output, error, true ) )
+	if ( ! execute_probe_command( "dumpe2fs -h " + partition .get_path(), true ) )
 	{
 		index = output .find( "Block count: " ) ;
 		if ( index >= output .length() ||
@@ -126,7 +126,7 @@ void ext3::set_used_sectors( Partition & partition )
 
 void ext3::read_label( Partition & partition )
 {
-	if ( ! Utils::execute_command( "e2label " + partition .get_path(), output, error, true ) )
+	if ( ! execute_probe_command( "e2label " + partition .get_path(), true ) )
 	{
 		partition .set_label( Utils::trim( output ) ) ;
 	}
@@ -147,7 +147,7 @@ bool ext3::write_label( const Partition & partition, OperationDetail & operation
 
 void ext3::read_uuid( Partition & partition )
 {
-	if ( ! Utils::execute_command( "tune2fs -l " + partition .get_path(), output, error, true ) )
+	if ( ! execute_probe_command( "dumpe2fs -h " + partition .get_path(), true ) )
 	{
 		partition .uuid = Utils::regexp_label( output, "^Filesystem UUID:[[:blank:]]*(" RFC4122_NONE_NIL_UUID_REGEXP ")" ) ;
 	}
@@ -166,6 +166,11 @@ bool ext3::write_uuid( const Partition & partition, OperationDetail & operationd
 	return ! execute_command( "tune2fs -U random " + partition .get_path(), operationdetail ) ;
 }
 
+bool ext3::write_label_and_uuid( const Partition & partition, OperationDetail & operationdetail )
+{
+	return ! execute_command( "tune2fs -L \"" + partition .get_label() + "\" -U random " + partition .get_path(), operationdetail ) ;
+}
+
 bool ext3::create( const Partition & new_partition, OperationDetail & operationdetail )
 {
 	return ! execute_command( "mkfs.ext3 -L \"" + new_partition .get_label() + "\" " + new_partition .get_path(), operationdetail ) ;
@@ -173,13 +178,13 @@ bool ext3::create( const Partition & new_partition, OperationDetail & operationd
 
 bool ext3::resize( const Partition & partition_new, OperationDetail & operationdetail, bool fill_partition )
 {
-	Glib::ustring str_temp = "resize2fs " + partition_new .get_path() ;
+	Glib::ustring str_temp = "resize2fs -p " + partition_new .get_path() ;
 	
 	if ( ! fill_partition )
 		str_temp += " " + Utils::num_to_str( Utils::round( Utils::sector_to_unit( 
 					partition_new .get_sector_length(), partition_new .sector_size, UNIT_KIB ) ) -1 ) + "K" ; 
 		
-	return ! execute_command( str_temp, operationdetail ) ;
+	return ! execute_command( str_temp, operationdetail, parse_resize2fs_progress ) ;
 }
 
 bool ext3::move( const Partition & partition_new
@@ -199,7 +204,9 @@ bool ext3::copy( const Glib::ustring & src_part_path,
 
 bool ext3::check_repair( const Partition & partition, OperationDetail & operationdetail )
 {
-	exit_status = execute_command( "e2fsck -f -y -v " + partition .get_path(), operationdetail ) ;
+	exit_status = execute_command( "e2fsck -f -y -v -C 0 " + partition .get_path(),
+	                               operationdetail,
+	                               parse_percent_progress ) ;
 
 	//exitstatus 256 isn't documented, but it's returned when the 'FILE SYSTEM IS MODIFIED'
 	//this is quite normal (especially after a copy) so we let the function return true...
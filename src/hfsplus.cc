@@ -55,7 +55,7 @@ void hfsplus::set_used_sectors( Partition & partition )
 
 void hfsplus::read_label( Partition & partition )
 {
-	if ( ! Utils::execute_command( "vol_id " + partition .get_path(), output, error, true ) )
+	if ( ! execute_probe_command( "vol_id " + partition .get_path(), true ) )
 	{
 		Glib::ustring label = Utils::regexp_label( output, "ID_FS_LABEL=([^\n]*)" ) ;
 		//FIXME: find a better way to see if label is empty.. imagine someone uses 'untitled' as label.... ;)
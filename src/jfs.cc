@@ -68,7 +68,7 @@ FS jfs::get_filesystem_support()
 
 void jfs::set_used_sectors( Partition & partition ) 
 {
-	if ( ! Utils::execute_command( "echo dm | jfs_debugfs " + partition .get_path(), output, error, true ) )
+	if ( ! execute_probe_command( "echo dm | jfs_debugfs " + partition .get_path(), true ) )
 	{
 		//blocksize
 		index = output .find( "Block Size:" ) ;
@@ -107,7 +107,7 @@ void jfs::set_used_sectors( Partition & partition )
 
 void jfs::read_label( Partition & partition )
 {
-	if ( ! Utils::execute_command( "jfs_tune -l " + partition .get_path(), output, error, true ) )
+	if ( ! execute_probe_command( "jfs_tune -l " + partition .get_path(), true ) )
 	{
 		partition .set_label( Utils::regexp_label( output, "^Volume label:[\t ]*'(.*)'" ) ) ;
 	}
@@ -128,7 +128,7 @@ bool jfs::write_label( const Partition & partition, OperationDetail & operationd
 
 void jfs::read_uuid( Partition & partition )
 {
-	if ( ! Utils::execute_command( "jfs_tune -l " + partition .get_path(), output, error, true ) )
+	if ( ! execute_probe_command( "jfs_tune -l " + partition .get_path(), true ) )
 	{
 		partition .uuid = Utils::regexp_label( output, "^File system UUID:[[:blank:]]*(" RFC4122_NONE_NIL_UUID_REGEXP ")" ) ;
 	}
@@ -70,7 +70,7 @@ void linux_swap::set_used_sectors( Partition & partition )
 
 void linux_swap::read_label( Partition & partition )
 {
-	if ( ! Utils::execute_command( "swaplabel " + partition .get_path(), output, error, true ) )
+	if ( ! execute_probe_command( "swaplabel " + partition .get_path(), true ) )
 	{
 		partition .set_label( Utils::regexp_label( output, "^LABEL:[[:blank:]]*(.*)$" ) ) ;
 	}
@@ -91,7 +91,7 @@ bool linux_swap::write_label( const Partition & partition, OperationDetail & ope
 
 void linux_swap::read_uuid( Partition & partition )
 {
-	if ( ! Utils::execute_command( "swaplabel " + partition .get_path(), output, error, true ) )
+	if ( ! execute_probe_command( "swaplabel " + partition .get_path(), true ) )
 	{
 		partition .uuid = Utils::regexp_label( output, "^UUID:[[:blank:]]*(" RFC4122_NONE_NIL_UUID_REGEXP ")" ) ;
 	}
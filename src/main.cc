@@ -20,6 +20,9 @@
 #include <gtkmm/messagedialog.h>
 #include <gtkmm/main.h>
 #include "../include/GParted_Core.h"
+#include "../include/DeviceFilter.h"
+#include "../include/IOThrottle.h"
+#include "../include/Dialog_Progress.h"
 
 int main( int argc, char *argv[] )
 {
@@ -51,10 +54,68 @@ int main( int argc, char *argv[] )
 	}
 
 	//deal with arguments..
+	//  The I/O options set how hard operations may load the disks and how many
+	//  may run in parallel.  Device filter
+	//  rules like --exclude=loop* are added after those from the configuration
+	//  file, anything else is a device to show.
 	std::vector<Glib::ustring> user_devices ;
+	GParted::DeviceFilter::load_rules( "/etc/gparted/device-filter.conf" ) ;
 	
 	for ( int t = 1 ; t < argc ; t++ )
-		user_devices .push_back( argv[ t ] ) ;
+	{
+		Glib::ustring arg = argv[ t ] ;
+		Glib::ustring::size_type equals = arg .find( '=' ) ;
+		Glib::ustring value = equals != Glib::ustring::npos ? arg .substr( equals + 1 ) : "" ;
+		if ( arg .substr( 0, equals ) == "--io-priority" )
+		{
+			if ( ! GParted::IOThrottle::set_priority( value ) )
+			{
+				std::cout << "Invalid option " << arg << std::endl ;
+				exit( 1 ) ;
+			}
+		}
+		else if ( arg .substr( 0, equals ) == "--io-bandwidth" || arg .substr( 0, equals ) == "--io-operations" )
+		{
+			char * end ;
+			long limit = strtol( value .c_str(), &end, 10 ) ;
+			if ( value .empty() || *end != '\0' || limit < 0 )
+			{
+				std::cout << "Invalid option " << arg << std::endl ;
+				exit( 1 ) ;
+			}
+
+			GParted::Byte_Value bytes_per_second ;
+			unsigned int ios_per_second ;
+			GParted::IOThrottle::get_limits( bytes_per_second, ios_per_second ) ;
+			if ( arg .substr( 0, equals ) == "--io-bandwidth" )
+				bytes_per_second = limit * GParted::MEBIBYTE ;
+			else
+				ios_per_second = limit ;
+			GParted::IOThrottle::set_limits( bytes_per_second, ios_per_second ) ;
+		}
+		else if ( arg .substr( 0, equals ) == "--parallel-operations" )
+		{
+			char * end ;
+			long max_operations = strtol( value .c_str(), &end, 10 ) ;
+			if ( value .empty() || *end != '\0' || max_operations < 1 )
+			{
+				std::cout << "Invalid option " << arg << std::endl ;
+				exit( 1 ) ;
+			}
+			GParted::Dialog_Progress::set_max_parallel_operations( max_operations ) ;
+		}
+		else if ( arg .substr( 0, 2 ) == "--" && equals != Glib::ustring::npos )
+		{
+			Glib::ustring rule = arg .substr( 2, equals - 2 ) + " " + arg .substr( equals + 1 ) ;
+			if ( ! GParted::DeviceFilter::add_rule( rule ) )
+			{
+				std::cout << "Invalid option " << arg << std::endl ;
+				exit( 1 ) ;
+			}
+		}
+		else
+			user_devices .push_back( arg ) ;
+	}
 	
 	GParted::Win_GParted win_gparted( user_devices ) ; 
 	Gtk::Main::run( win_gparted ) ;
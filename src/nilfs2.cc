@@ -65,7 +65,7 @@ FS nilfs2::get_filesystem_support()
 
 void nilfs2::set_used_sectors( Partition & partition )
 {
-	if ( ! Utils::execute_command( "nilfs-tune -l " + partition .get_path(), output, error, true ) )
+	if ( ! execute_probe_command( "nilfs-tune -l " + partition .get_path(), true ) )
 	{
 		//File system size in bytes
 		Glib::ustring::size_type index = output .find( "Device size:" ) ;
@@ -106,7 +106,7 @@ void nilfs2::set_used_sectors( Partition & partition )
 
 void nilfs2::read_label( Partition & partition )
 {
-	if ( ! Utils::execute_command( "nilfs-tune -l " + partition .get_path(), output, error, true ) )
+	if ( ! execute_probe_command( "nilfs-tune -l " + partition .get_path(), true ) )
 	{
 		Glib::ustring label = Utils::regexp_label( output, "^Filesystem volume name:[\t ]*(.*)$" ) ;
 		if ( label != "(none)" )
@@ -131,7 +131,7 @@ bool nilfs2::write_label( const Partition & partition, OperationDetail & operati
 
 void nilfs2::read_uuid( Partition & partition )
 {
-	if ( ! Utils::execute_command( "nilfs-tune -l " + partition .get_path(), output, error, true ) )
+	if ( ! execute_probe_command( "nilfs-tune -l " + partition .get_path(), true ) )
 	{
 		partition .uuid = Utils::regexp_label( output, "^Filesystem UUID:[[:blank:]]*(" RFC4122_NONE_NIL_UUID_REGEXP ")" ) ;
 	}
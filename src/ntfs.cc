@@ -110,8 +110,8 @@ FS ntfs::get_filesystem_support()
 
 void ntfs::set_used_sectors( Partition & partition ) 
 {
-	if ( ! Utils::execute_command( 
-		"ntfsresize --info --force --no-progress-bar " + partition .get_path(), output, error, true ) )
+	if ( ! execute_probe_command( 
+		"ntfsresize --info --force --no-progress-bar " + partition .get_path(), true ) )
 	{
 		index = output .find( "Current volume size:" ) ;
 		if ( index >= output .length() ||
@@ -142,7 +142,7 @@ void ntfs::set_used_sectors( Partition & partition )
 
 void ntfs::read_label( Partition & partition )
 {
-	if ( ! Utils::execute_command( "ntfslabel --force " + partition .get_path(), output, error, false ) )
+	if ( ! execute_probe_command( "ntfslabel --force " + partition .get_path() ) )
 	{
 		partition .set_label( Utils::trim( output ) ) ;
 	}
@@ -175,6 +175,13 @@ bool ntfs::write_uuid( const Partition & partition, OperationDetail & operationd
 	return true ;
 }
 
+bool ntfs::write_label_and_uuid( const Partition & partition, OperationDetail & operationdetail )
+{
+	Glib::ustring serial = partition .uuid == UUID_RANDOM_NTFS_HALF ? "--new-half-serial " : "--new-serial " ;
+	return ! execute_command( "ntfslabel --force " + serial + partition .get_path() + " \"" + partition .get_label() + "\"",
+	                          operationdetail ) ;
+}
+
 bool ntfs::create( const Partition & new_partition, OperationDetail & operationdetail )
 {
 	return ! execute_command( "mkntfs -Q -v -L \"" + new_partition .get_label() + "\" " + new_partition .get_path(), operationdetail ) ;
@@ -183,7 +190,7 @@ bool ntfs::create( const Partition & new_partition, OperationDetail & operationd
 bool ntfs::resize( const Partition & partition_new, OperationDetail & operationdetail, bool fill_partition )
 {
 	bool return_value = false ;
-	Glib::ustring str_temp = "ntfsresize -P --force --force " + partition_new .get_path() ;
+	Glib::ustring str_temp = "ntfsresize --force --force " + partition_new .get_path() ;
 	
 	if ( ! fill_partition )
 	{
@@ -195,14 +202,14 @@ bool ntfs::resize( const Partition & partition_new, OperationDetail & operationd
 	//simulation..
 	operationdetail .add_child( OperationDetail( _("run simulation") ) ) ;
 
-	if ( ! execute_command( str_temp + " --no-action", operationdetail .get_last_child() ) )
+	if ( ! execute_command( str_temp + " -P --no-action", operationdetail .get_last_child() ) )
 	{
 		operationdetail .get_last_child() .set_status( STATUS_SUCCES ) ;
 
 		//real resize
 		operationdetail .add_child( OperationDetail( _("real resize") ) ) ;
 
-		if ( ! execute_command( str_temp, operationdetail .get_last_child() ) )
+		if ( ! execute_command( str_temp, operationdetail .get_last_child(), parse_percent_progress ) )
 		{
 			operationdetail .get_last_child() .set_status( STATUS_SUCCES ) ;
 			return_value = true ;
@@ -232,7 +239,9 @@ bool ntfs::copy( const Glib::ustring & src_part_path,
 		 const Glib::ustring & dest_part_path, 
 		 OperationDetail & operationdetail )
 {
-	return ! execute_command( "ntfsclone -f --overwrite " + dest_part_path + " " + src_part_path, operationdetail ) ;
+	return ! execute_command( "ntfsclone -f --overwrite " + dest_part_path + " " + src_part_path,
+	                          operationdetail,
+	                          parse_percent_progress ) ;
 }
 
 bool ntfs::check_repair( const Partition & partition, OperationDetail & operationdetail )
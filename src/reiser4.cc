@@ -58,7 +58,7 @@ FS reiser4::get_filesystem_support()
 
 void reiser4::set_used_sectors( Partition & partition ) 
 {
-	if ( ! Utils::execute_command( "debugfs.reiser4 " + partition .get_path(), output, error, true ) )
+	if ( ! execute_probe_command( "debugfs.reiser4 " + partition .get_path(), true ) )
 	{
 		index = output .find( "\nblocks:" ) ;
 		if ( index >= output .length() ||
@@ -94,7 +94,7 @@ void reiser4::set_used_sectors( Partition & partition )
 
 void reiser4::read_label( Partition & partition )
 {
-	if ( ! Utils::execute_command( "debugfs.reiser4 " + partition .get_path(), output, error, true ) )
+	if ( ! execute_probe_command( "debugfs.reiser4 " + partition .get_path(), true ) )
 	{
 		Glib::ustring label = Utils::regexp_label( output, "^label:[[:blank:]]*(.*)$" ) ;
 		if ( label != "<none>" )
@@ -119,7 +119,7 @@ bool reiser4::write_label( const Partition & partition, OperationDetail & operat
 
 void reiser4::read_uuid( Partition & partition )
 {
-	if ( ! Utils::execute_command( "debugfs.reiser4 " + partition .get_path(), output, error, true ) )
+	if ( ! execute_probe_command( "debugfs.reiser4 " + partition .get_path(), true ) )
 	{
 		partition .uuid = Utils::regexp_label( output, "uuid:[[:blank:]]*(" RFC4122_NONE_NIL_UUID_REGEXP ")" ) ;
 	}
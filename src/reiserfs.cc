@@ -71,7 +71,7 @@ FS reiserfs::get_filesystem_support()
 
 void reiserfs::set_used_sectors( Partition & partition ) 
 {
-	if ( ! Utils::execute_command( "debugreiserfs " + partition .get_path(), output, error, true ) )
+	if ( ! execute_probe_command( "debugreiserfs " + partition .get_path(), true ) )
 	{
 		index = output .find( "Count of blocks on the device:" ) ;
 		if ( index >= output .length() ||
@@ -107,7 +107,7 @@ void reiserfs::set_used_sectors( Partition & partition )
 
 void reiserfs::read_label( Partition & partition )
 {
-	if ( ! Utils::execute_command( "debugreiserfs " + partition .get_path(), output, error, true ) )
+	if ( ! execute_probe_command( "debugreiserfs " + partition .get_path(), true ) )
 	{
 		partition .set_label( Utils::regexp_label( output, "^label:[\t ]*(.*)$" ) ) ;
 	}
@@ -128,7 +128,7 @@ bool reiserfs::write_label( const Partition & partition, OperationDetail & opera
 
 void reiserfs::read_uuid( Partition & partition )
 {
-	if ( ! Utils::execute_command( "debugreiserfs " + partition .get_path(), output, error, true ) )
+	if ( ! execute_probe_command( "debugreiserfs " + partition .get_path(), true ) )
 	{
 		partition .uuid = Utils::regexp_label( output, "^UUID:[[:blank:]]*(" RFC4122_NONE_NIL_UUID_REGEXP ")" ) ;
 	}
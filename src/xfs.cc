@@ -75,10 +75,8 @@ FS xfs::get_filesystem_support()
 
 void xfs::set_used_sectors( Partition & partition ) 
 {
-	if ( ! Utils::execute_command( 
+	if ( ! execute_probe_command( 
 			"xfs_db -c 'sb 0' -c 'print blocksize' -c 'print dblocks' -c 'print fdblocks' -r " + partition .get_path(),
-			output,
-			error,
 			true ) )
 	{
 		//blocksize
@@ -117,7 +115,7 @@ void xfs::set_used_sectors( Partition & partition )
 
 void xfs::read_label( Partition & partition )
 {
-	if ( ! Utils::execute_command( "xfs_db -r -c 'label' " + partition .get_path(), output, error, true ) )
+	if ( ! execute_probe_command( "xfs_db -r -c 'label' " + partition .get_path(), true ) )
 	{
 		partition .set_label( Utils::regexp_label( output, "^label = \"(.*)\"" ) ) ;
 	}
@@ -143,7 +141,7 @@ bool xfs::write_label( const Partition & partition, OperationDetail & operationd
 
 void xfs::read_uuid( Partition & partition )
 {
-	if ( ! Utils::execute_command( "xfs_admin -u " + partition .get_path(), output, error, true ) )
+	if ( ! execute_probe_command( "xfs_admin -u " + partition .get_path(), true ) )
 	{
 		partition .uuid = Utils::regexp_label( output, "^UUID[[:blank:]]*=[[:blank:]]*(" RFC4122_NONE_NIL_UUID_REGEXP ")" ) ;
 	}
@@ -162,6 +160,16 @@ bool xfs::write_uuid( const Partition & partition, OperationDetail & operationde
 	return ! execute_command( "xfs_admin -U generate " + partition .get_path(), operationdetail ) ;
 }
 
+bool xfs::write_label_and_uuid( const Partition & partition, OperationDetail & operationdetail )
+{
+	Glib::ustring cmd = "" ;
+	if( partition .get_label() .empty() )
+		cmd = String::ucompose( "xfs_admin -L -- -U generate %1", partition .get_path() ) ;
+	else
+		cmd = String::ucompose( "xfs_admin -L \"%1\" -U generate %2", partition .get_label(), partition .get_path() ) ;
+	return ! execute_command( cmd, operationdetail ) ;
+}
+
 bool xfs::create( const Partition & new_partition, OperationDetail & operationdetail )
 {
 	//mkfs.xfs will not create file system if label is longer than 12 characters, hence truncation.